@@ -0,0 +1,602 @@
+// CPU-side microbenchmarks for per-frame and startup code paths.
+// Run with --benchmark_format=json (or --benchmark_out=<file> --benchmark_out_format=json) for machine-readable results.
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "shader.cpp"
+#include "camera.h"
+#include "scene.h"
+#include "texture.h"
+#include "headless.h"
+#include "stb_image.h"
+#include "image_allocator.h"
+#include "texture_cache.h"
+#include "asset_io.h"
+
+// Set by CMake so the benchmarks can run from any working directory
+#ifndef ASSET_ROOT
+#define ASSET_ROOT "../"
+#endif
+
+const char *VERTEX_FILE_PATH = ASSET_ROOT "vert.glsl";
+const char *CUBE_FRAG_FILE_PATH = ASSET_ROOT "cube_frag.glsl";
+const char *DIFFUSE_TEXTURE_PATH = ASSET_ROOT "assets/container2.png";
+const char *SPEC_TEXTURE_PATH = ASSET_ROOT "assets/container2_specular.png";
+
+// Shared offscreen context for benchmarks that need GL, created on first use
+static bool ensureGLContext()
+{
+    static HeadlessContext context;
+    static bool isInitialized = false;
+    static bool isAvailable = false;
+    if (!isInitialized)
+    {
+        isInitialized = true;
+        isAvailable = context.init(64, 64) && gladLoadGLLoader((GLADloadproc)HeadlessContext::getProcAddress);
+    }
+    return isAvailable;
+}
+
+static std::vector<unsigned char> readBytes(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// -- Camera --
+
+static void BM_CameraViewMatrix(benchmark::State &state)
+{
+    Camera camera(glm::vec3(0.f, 0.f, 3.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(camera.getViewMatrix());
+    }
+}
+BENCHMARK(BM_CameraViewMatrix);
+
+// updateCameraVectors after every orientation change, setEulerAngles switches to EULER so QUATERNION goes through rotate
+static void BM_CameraUpdateVectors(benchmark::State &state)
+{
+    Camera camera(glm::vec3(0.f, 0.f, 3.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    camera.setOrientationMode(static_cast<Camera_Orientation>(state.range(0)));
+    bool isQuaternion = state.range(0) == QUATERNION;
+    float yaw = -90.f;
+    for (auto _ : state)
+    {
+        yaw += .1f;
+        if (isQuaternion)
+            camera.rotate(.1f, 0.f);
+        else
+            camera.setEulerAngles(yaw, 10.f);
+        benchmark::DoNotOptimize(camera.getFront());
+    }
+}
+BENCHMARK(BM_CameraUpdateVectors)->Arg(EULER)->Arg(QUATERNION);
+
+static void BM_CameraMouseMovement(benchmark::State &state)
+{
+    Camera camera(glm::vec3(0.f, 0.f, 3.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    camera.setOrientationMode(static_cast<Camera_Orientation>(state.range(0)));
+    for (auto _ : state)
+    {
+        camera.processMouseMovement(1.f, .25f);
+        benchmark::DoNotOptimize(camera.getFront());
+    }
+}
+BENCHMARK(BM_CameraMouseMovement)->Arg(EULER)->Arg(QUATERNION);
+
+// -- Transforms --
+
+static void BM_CubeMatrices(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        for (unsigned int i = 0; i < CUBE_COUNT; i++)
+        {
+            glm::mat4 model = cubeModelMatrix(i);
+            glm::mat3 normalModel = normalMatrix(model);
+            benchmark::DoNotOptimize(model);
+            benchmark::DoNotOptimize(normalModel);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * CUBE_COUNT);
+}
+BENCHMARK(BM_CubeMatrices);
+
+static void BM_LightMatrices(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        for (unsigned int i = 0; i < POINT_LIGHT_COUNT; i++)
+        {
+            benchmark::DoNotOptimize(lightModelMatrix(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * POINT_LIGHT_COUNT);
+}
+BENCHMARK(BM_LightMatrices);
+
+// -- Startup --
+
+static void BM_ShaderReadSource(benchmark::State &state)
+{
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::string source = Shader::readSource(CUBE_FRAG_FILE_PATH);
+        benchmark::DoNotOptimize(source.data());
+        bytes = source.size();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ShaderReadSource);
+
+// Every startup file, one after another and then as a single AssetReader batch
+static const char *STARTUP_FILES[] = { VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH, DIFFUSE_TEXTURE_PATH, SPEC_TEXTURE_PATH };
+
+static void BM_ReadAssetsSerial(benchmark::State &state)
+{
+    size_t totalBytes = 0;
+    for (auto _ : state)
+    {
+        totalBytes = 0;
+        for (const char *path : STARTUP_FILES)
+        {
+            std::vector<unsigned char> bytes = readBytes(path);
+            benchmark::DoNotOptimize(bytes.data());
+            totalBytes += bytes.size();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(totalBytes));
+}
+BENCHMARK(BM_ReadAssetsSerial)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReadAssetsBatched(benchmark::State &state)
+{
+    AssetReader reader;
+    reader.init();
+    std::vector<unsigned char> buffers[4];
+    size_t totalBytes = 0;
+    for (auto _ : state)
+    {
+        for (unsigned int i = 0; i < 4; i++)
+            reader.read(STARTUP_FILES[i], buffers[i]);
+        reader.waitAll();
+        totalBytes = 0;
+        for (const std::vector<unsigned char> &bytes : buffers)
+        {
+            benchmark::DoNotOptimize(bytes.data());
+            totalBytes += bytes.size();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(totalBytes));
+    state.SetLabel(reader.isUsingRing() ? "io_uring" : "pread threads");
+    reader.destroy();
+}
+BENCHMARK(BM_ReadAssetsBatched)->Unit(benchmark::kMicrosecond);
+
+// The decode half of loadTexture, independent of any GL context
+static void BM_TextureDecode(benchmark::State &state)
+{
+    int64_t bytes = 0;
+    for (auto _ : state)
+    {
+        int width, height, nrComponents;
+        unsigned char *data = stbi_load(DIFFUSE_TEXTURE_PATH, &width, &height, &nrComponents, 0);
+        if (!data)
+        {
+            state.SkipWithError("Failed to decode texture");
+            break;
+        }
+        benchmark::DoNotOptimize(data);
+        bytes = static_cast<int64_t>(width) * height * nrComponents;
+        stbi_image_free(data);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_TextureDecode)->Unit(benchmark::kMillisecond);
+
+// Same decode with scratch in the thread arena and the output recycled through the pool
+static void BM_TextureDecodeArena(benchmark::State &state)
+{
+    ImageDecodeStats stats;
+    int64_t bytes = 0;
+    for (auto _ : state)
+    {
+        int width, height, nrComponents;
+        unsigned char *data = decodeImageFile(DIFFUSE_TEXTURE_PATH, &width, &height, &nrComponents, 0, &stats);
+        if (!data)
+        {
+            state.SkipWithError("Failed to decode texture");
+            break;
+        }
+        benchmark::DoNotOptimize(data);
+        bytes = static_cast<int64_t>(width) * height * nrComponents;
+        stbi_image_free(data);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["allocations"] = stats.allocations;
+    state.counters["peak_bytes"] = static_cast<double>(stats.peakBytes);
+}
+BENCHMARK(BM_TextureDecodeArena)->Unit(benchmark::kMillisecond);
+
+// Decode, import, upload and mipmap generation
+static void BM_LoadTexture(benchmark::State &state, const char *path, TextureUsage usage)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    for (auto _ : state)
+    {
+        unsigned int texture = loadTexture(path, usage);
+        glFinish();
+        state.PauseTiming();
+        glDeleteTextures(1, &texture);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK_CAPTURE(BM_LoadTexture, diffuse_srgb, DIFFUSE_TEXTURE_PATH, TEXTURE_USAGE_COLOR)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadTexture, specular_r8, SPEC_TEXTURE_PATH, TEXTURE_USAGE_DATA)->Unit(benchmark::kMillisecond);
+
+// Grey detection and repacking, the CPU cost the import stage adds to every decode
+static void BM_TextureImport(benchmark::State &state)
+{
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(SPEC_TEXTURE_PATH, &width, &height, &nrComponents, 4);
+    if (!data)
+    {
+        state.SkipWithError("Failed to decode texture");
+        return;
+    }
+    std::vector<unsigned char> pixels(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    std::vector<unsigned char> scratch;
+    for (auto _ : state)
+    {
+        scratch = pixels;
+        TextureImport import = importTexture(scratch.data(), width, height, TEXTURE_USAGE_DATA);
+        benchmark::DoNotOptimize(import);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixels.size()));
+}
+BENCHMARK(BM_TextureImport)->Unit(benchmark::kMicrosecond);
+
+// Warm-run path of the decode cache: map the imported entry and read every pixel, compare with BM_TextureDecode
+static void BM_TextureCacheMap(benchmark::State &state)
+{
+    int width, height, nrComponents;
+    unsigned char *data = decodeImageFile(DIFFUSE_TEXTURE_PATH, &width, &height, &nrComponents, 4);
+    TextureCache cache;
+    if (!data || !cache.init("texture_cache_benchmark"))
+    {
+        stbi_image_free(data);
+        state.SkipWithError("Failed to prepare the cache entry");
+        return;
+    }
+    const uint64_t KEY = 1;
+    cache.store(KEY, data, width, height, importTexture(data, width, height, TEXTURE_USAGE_COLOR));
+    stbi_image_free(data);
+
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        TextureCacheEntry entry;
+        if (!cache.find(KEY, entry))
+        {
+            state.SkipWithError("Cache entry missing");
+            break;
+        }
+        bytes = static_cast<size_t>(entry.width) * entry.height * entry.import.components;
+        unsigned int sum = 0;
+        for (size_t i = 0; i < bytes; i += 64)
+            sum += entry.pixels[i];
+        benchmark::DoNotOptimize(sum);
+        TextureCache::release(entry);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_TextureCacheMap)->Unit(benchmark::kMicrosecond);
+
+// Decode into pooled memory, then glTexSubImage2D copies it into the driver
+static void BM_DecodeUploadHeap(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    std::vector<unsigned char> bytes = readBytes(DIFFUSE_TEXTURE_PATH);
+    int width = 0, height = 0, nrComponents;
+    stbi_info_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &nrComponents);
+    ImageDecodeStats stats;
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    for (auto _ : state)
+    {
+        unsigned char *data = decodeImage(bytes.data(), bytes.size(), &width, &height, &nrComponents, 4, &stats);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glFinish();
+        stbi_image_free(data);
+    }
+    glDeleteTextures(1, &texture);
+    state.counters["peak_bytes"] = static_cast<double>(stats.peakBytes);
+    state.counters["copied_bytes"] = static_cast<double>(static_cast<size_t>(width) * height * 4);
+}
+BENCHMARK(BM_DecodeUploadHeap)->Unit(benchmark::kMillisecond);
+
+// Decode straight into a mapped pixel unpack buffer and create the texture from its offset
+static void BM_DecodeUploadMapped(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    std::vector<unsigned char> bytes = readBytes(DIFFUSE_TEXTURE_PATH);
+    size_t regionBytes = imageDecodeBytes(bytes.data(), bytes.size(), 4) + IMAGE_BLOCK_HEADER_BYTES;
+    int width = 0, height = 0, nrComponents;
+    stbi_info_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &nrComponents);
+    ImageDecodeStats stats;
+    unsigned int texture, buffer;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    for (auto _ : state)
+    {
+        // The decoder reads back earlier rows while filtering, so the mapping has to be readable
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, regionBytes, NULL, GL_STREAM_DRAW);
+        unsigned char *region = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, regionBytes, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT));
+        unsigned char *data = region ? decodeImageInto(bytes.data(), bytes.size(), region, regionBytes, &width, &height, &nrComponents, 4, &stats) : nullptr;
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        if (!data)
+        {
+            state.SkipWithError("Failed to decode into the pixel buffer");
+            break;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)IMAGE_BLOCK_HEADER_BYTES);
+        glFinish();
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    glDeleteTextures(1, &texture);
+    state.counters["peak_bytes"] = static_cast<double>(stats.peakBytes);
+    state.counters["copied_bytes"] = static_cast<double>(stats.copiedBytes);
+}
+BENCHMARK(BM_DecodeUploadMapped)->Unit(benchmark::kMillisecond);
+
+static void BM_CreateCubeVAO(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    for (auto _ : state)
+    {
+        unsigned int VBO;
+        unsigned int VAO = createCubeVAO(VBO, true);
+        state.PauseTiming();
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_CreateCubeVAO);
+
+// -- Uniforms --
+
+// The per-frame point light upload as done in the render loop: names built with stringstream, looked up every call
+static void BM_PointLightUniformsByName(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    Shader cubeShader(VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH);
+    cubeShader.use();
+    for (auto _ : state)
+    {
+        for (unsigned int i = 0; i < POINT_LIGHT_COUNT; i++)
+        {
+            std::stringstream uniformName;
+            uniformName << "pointLights[" << i << "].";
+
+            cubeShader.setVec3(uniformName.str() + "position", POINT_LIGHT_POSITIONS[i]);
+            cubeShader.setVec3(uniformName.str() + "ambient", POINT_LIGHT_COLORS[i] * 0.1f);
+            cubeShader.setVec3(uniformName.str() + "diffuse", POINT_LIGHT_COLORS[i]);
+            cubeShader.setVec3(uniformName.str() + "specular", POINT_LIGHT_COLORS[i]);
+            cubeShader.setFloat(uniformName.str() + "constant", 1.f);
+            cubeShader.setFloat(uniformName.str() + "linear", .09f);
+            cubeShader.setFloat(uniformName.str() + "quadratic", .032f);
+        }
+    }
+    glDeleteProgram(cubeShader.ID);
+}
+BENCHMARK(BM_PointLightUniformsByName);
+
+// Same upload with locations resolved up front, the lower bound for the by-name path
+static void BM_PointLightUniformsByLocation(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    Shader cubeShader(VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH);
+    cubeShader.use();
+
+    const char *FIELDS[] = { "position", "ambient", "diffuse", "specular", "constant", "linear", "quadratic" };
+    int locations[POINT_LIGHT_COUNT][7];
+    for (unsigned int i = 0; i < POINT_LIGHT_COUNT; i++)
+    {
+        for (unsigned int field = 0; field < 7; field++)
+        {
+            std::string name = "pointLights[" + std::to_string(i) + "]." + FIELDS[field];
+            locations[i][field] = glGetUniformLocation(cubeShader.ID, name.c_str());
+        }
+    }
+
+    for (auto _ : state)
+    {
+        for (unsigned int i = 0; i < POINT_LIGHT_COUNT; i++)
+        {
+            glm::vec3 ambient = POINT_LIGHT_COLORS[i] * 0.1f;
+            glUniform3fv(locations[i][0], 1, glm::value_ptr(POINT_LIGHT_POSITIONS[i]));
+            glUniform3fv(locations[i][1], 1, glm::value_ptr(ambient));
+            glUniform3fv(locations[i][2], 1, glm::value_ptr(POINT_LIGHT_COLORS[i]));
+            glUniform3fv(locations[i][3], 1, glm::value_ptr(POINT_LIGHT_COLORS[i]));
+            glUniform1f(locations[i][4], 1.f);
+            glUniform1f(locations[i][5], .09f);
+            glUniform1f(locations[i][6], .032f);
+        }
+    }
+    glDeleteProgram(cubeShader.ID);
+}
+BENCHMARK(BM_PointLightUniformsByLocation);
+
+static void BM_CubeTransformUniforms(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    Shader cubeShader(VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH);
+    cubeShader.use();
+    for (auto _ : state)
+    {
+        for (unsigned int i = 0; i < CUBE_COUNT; i++)
+        {
+            glm::mat4 model = cubeModelMatrix(i);
+            cubeShader.setMat4("model", model);
+            cubeShader.setMat3("normalModel", normalMatrix(model));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * CUBE_COUNT);
+    glDeleteProgram(cubeShader.ID);
+}
+BENCHMARK(BM_CubeTransformUniforms);
+
+// -- Fragment shading --
+
+// GPU time of the cube fragment shader with the cube filling a 1024x1024 target, 0 = generic (uniform point count, spot
+// light always evaluated), 1 = specialized flashlight off, 2 = specialized flashlight on
+static void BM_CubeFragmentCost(benchmark::State &state)
+{
+    if (!ensureGLContext())
+    {
+        state.SkipWithError("No headless GL context");
+        return;
+    }
+    const int TARGET_SIZE = 1024;
+    const unsigned int DRAWS_PER_ITERATION = 8;
+    const char *LABELS[] = { "generic, flashlight off", "flashlight off", "flashlight on" };
+    int variant = static_cast<int>(state.range(0));
+    bool hasSpotLight = variant != 1;
+    Shader cubeShader(VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH, variant == 0 ? "" : lightingDefines(POINT_LIGHT_COUNT, hasSpotLight));
+
+    unsigned int FBO, colorBuffer, depthBuffer;
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_SIZE, TARGET_SIZE);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, TARGET_SIZE, TARGET_SIZE);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    glEnable(GL_DEPTH_TEST);
+
+    unsigned int diffuseMap = loadTexture(DIFFUSE_TEXTURE_PATH, TEXTURE_USAGE_COLOR);
+    unsigned int specularMap = loadTexture(SPEC_TEXTURE_PATH, TEXTURE_USAGE_DATA);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, diffuseMap);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, specularMap);
+    unsigned int VBO;
+    unsigned int VAO = createCubeVAO(VBO, true);
+
+    // Camera just outside the front face so every pixel runs the full shader
+    glm::vec3 viewPos(0.f, 0.f, 1.2f);
+    cubeShader.use();
+    cubeShader.setInt("material.diffuse", 0);
+    cubeShader.setInt("material.specular", 1);
+    cubeShader.setFloat("material.shininess", 64.f);
+    cubeShader.setMat4("model", glm::mat4(1.f));
+    cubeShader.setMat3("normalModel", glm::mat3(1.f));
+    cubeShader.setMat4("view", glm::lookAt(viewPos, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f)));
+    cubeShader.setMat4("projection", glm::perspective(glm::radians(90.f), 1.f, .1f, 10.f));
+    cubeShader.setVec3("viewPos", viewPos);
+    cubeShader.setVec3("dirLight.direction", glm::vec3(-.2f, -1.f, -.3f));
+    cubeShader.setVec3("dirLight.diffuse", glm::vec3(.4f));
+    cubeShader.setVec3("dirLight.specular", glm::vec3(.5f));
+    cubeShader.setInt("pointLightCount", POINT_LIGHT_COUNT);
+    for (unsigned int i = 0; i < POINT_LIGHT_COUNT; i++)
+    {
+        std::string uniformName = "pointLights[" + std::to_string(i) + "].";
+        cubeShader.setVec3(uniformName + "position", POINT_LIGHT_POSITIONS[i]);
+        cubeShader.setVec3(uniformName + "ambient", POINT_LIGHT_COLORS[i] * 0.1f);
+        cubeShader.setVec3(uniformName + "diffuse", POINT_LIGHT_COLORS[i]);
+        cubeShader.setVec3(uniformName + "specular", POINT_LIGHT_COLORS[i]);
+        cubeShader.setFloat(uniformName + "constant", 1.f);
+        cubeShader.setFloat(uniformName + "linear", .09f);
+        cubeShader.setFloat(uniformName + "quadratic", .032f);
+    }
+    // The generic shader with the flashlight off still evaluates it with zero colors, as the render loop used to.
+    // The specialized flashlight-off variant compiles it out, so only the flashlight-on variant lights it.
+    float spotStrength = variant == 2 ? 1.f : 0.f;
+    cubeShader.setVec3("spotLight.position", viewPos);
+    cubeShader.setVec3("spotLight.direction", glm::vec3(0.f, 0.f, -1.f));
+    cubeShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(8.5f)));
+    cubeShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(11.5f)));
+    cubeShader.setFloat("spotLight.constant", 1.f);
+    cubeShader.setFloat("spotLight.linear", .09f);
+    cubeShader.setFloat("spotLight.quadratic", .032f);
+    cubeShader.setVec3("spotLight.ambient", glm::vec3(.05f) * spotStrength);
+    cubeShader.setVec3("spotLight.diffuse", glm::vec3(2.f) * spotStrength);
+    cubeShader.setVec3("spotLight.specular", glm::vec3(1.f) * spotStrength);
+
+    // Clear before every draw so the depth test never rejects the repeated cube
+    for (auto _ : state)
+    {
+        for (unsigned int draw = 0; draw < DRAWS_PER_ITERATION; draw++)
+        {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+        glFinish();
+    }
+    state.SetItemsProcessed(state.iterations() * DRAWS_PER_ITERATION * TARGET_SIZE * TARGET_SIZE);
+    state.SetLabel(LABELS[variant]);
+
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteTextures(1, &diffuseMap);
+    glDeleteTextures(1, &specularMap);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteFramebuffers(1, &FBO);
+    glDisable(GL_DEPTH_TEST);
+    glDeleteProgram(cubeShader.ID);
+}
+BENCHMARK(BM_CubeFragmentCost)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
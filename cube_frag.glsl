@@ -8,7 +8,6 @@ struct Material
 {
     sampler2D diffuse;
     sampler2D specular;
-    sampler2D emission;
     float shininess;
 };
 
@@ -47,6 +46,16 @@ struct SpotLight
 
 #define NR_POINT_LIGHTS 4
 
+// Light set specialization, the renderer compiles one variant per active set (see lightingDefines).
+// Without the defines every light is evaluated and the point light count comes from the uniform.
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+#ifndef ACTIVE_POINT_LIGHTS
+uniform int pointLightCount;
+#define ACTIVE_POINT_LIGHTS pointLightCount
+#endif
+
 uniform Material material;
 uniform DirLight dirLight;
 uniform PointLight pointLights[NR_POINT_LIGHTS];
@@ -54,31 +63,86 @@ uniform SpotLight spotLight;
 uniform vec3 viewPos;
 uniform sampler2D textureSrc;
 
+#ifdef MATERIAL_ARRAY
+// Material maps packed into array layers, indexed by the instance's material
+uniform sampler2DArray diffuseArray;
+uniform sampler2DArray specularArray;
+flat in float MaterialLayer;
+#define DIFFUSE_MAP(uv) texture(diffuseArray, vec3(uv, MaterialLayer))
+#define SPECULAR_MAP(uv) texture(specularArray, vec3(uv, MaterialLayer))
+#else
+#define DIFFUSE_MAP(uv) texture(material.diffuse, uv)
+#define SPECULAR_MAP(uv) texture(material.specular, uv)
+#endif
+
+#ifdef BAKED_LIGHTING
+// Diffuse irradiance of the static lights, direct and indirect, baked offline (tools/lightmap_bake.cpp)
+uniform sampler2D lightmap;
+in vec2 LightmapCoords;
+#endif
+
+#ifdef PROBE_LIGHTING
+// Bounce light of the static lights as L2 spherical harmonics on a grid of probes, baked offline (tools/probe_bake.cpp).
+// The seven RGBA slots of every probe are stacked along z, slot s of probe cell c is at texel (c.x, c.y, s * counts.z + c.z).
+uniform sampler3D probeGrid;
+uniform vec3 probeGridMin;
+uniform float probeGridSpacing;
+uniform vec3 probeGridCounts;
+
+// One lookup replaces the ambient term of every light
+#define AMBIENT(light) vec3(0.0)
+#else
+#define AMBIENT(light) (light.ambient * surface.diffuse)
+#endif
+
 out vec4 FragColor;
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+// Lighting maps, sampled once per fragment and shared by every light
+struct Surface
+{
+    vec3 diffuse;
+    vec3 specular;
+};
+
+vec3 CalcDirLight(DirLight light, Surface surface, vec3 normal, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir);
+#ifdef PROBE_LIGHTING
+vec3 CalcProbeIrradiance(vec3 normal, vec3 fragPos);
+#endif
 
 void main()
 {
     vec3 normal = normalize(FragNorm);
     vec3 viewDir = normalize(viewPos - FragPos);
+    Surface surface = Surface(vec3(DIFFUSE_MAP(TextCoords)), vec3(SPECULAR_MAP(TextCoords)));
 
+#ifdef BAKED_LIGHTING
+    // Directional and point lights, their bounce light replaces the ambient terms and their specular is not baked
+    vec3 result = surface.diffuse * texture(lightmap, LightmapCoords).rgb;
+#else
     // Directional light
-    vec3 result = CalcDirLight(dirLight, normal, viewDir);
+    vec3 result = CalcDirLight(dirLight, surface, normal, viewDir);
 
     // Point lights
-    for (int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], normal, FragPos, viewDir);
-    
+    for (int i = 0; i < ACTIVE_POINT_LIGHTS; i++)
+        result += CalcPointLight(pointLights[i], surface, normal, FragPos, viewDir);
+#endif
+
+#ifdef PROBE_LIGHTING
+    // Indirect light
+    result += surface.diffuse * CalcProbeIrradiance(normal, FragPos);
+#endif
+
+#if SPOT_LIGHT
     // Spot light
-    result += CalcSpotLight(spotLight, normal, FragPos, viewDir);
+    result += CalcSpotLight(spotLight, surface, normal, FragPos, viewDir);
+#endif
 
     FragColor = vec4(result, 1.0);
 }
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirLight(DirLight light, Surface surface, vec3 normal, vec3 viewDir)
 {
     // Calculate vectors and specular strength
     vec3 lightDir = normalize(-light.direction);
@@ -87,14 +151,14 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
 
     // Lighting maps
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TextCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TextCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TextCoords));
+    vec3 ambient = AMBIENT(light);
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
 
     return (ambient + diffuse + specular);
 }
 
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
     // Calculate vectors and specular strength
     vec3 lightDir = normalize(light.position - fragPos);
@@ -107,9 +171,9 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
 
     // Lighting maps
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TextCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TextCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TextCoords));
+    vec3 ambient = AMBIENT(light);
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
     ambient  *= attenuation;
     diffuse  *= attenuation;
     specular *= attenuation;
@@ -117,20 +181,19 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     return (ambient + diffuse + specular);
 }
 
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcSpotLight(SpotLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
     // Ambient
-    vec3 ambient = (light.ambient * vec3(texture(material.diffuse, TextCoords))) + vec3(texture(material.emission, TextCoords));
+    vec3 ambient = AMBIENT(light);
     // Diffuse
-    vec3 norm = normalize(normal);
     vec3 lightDir = normalize(light.position - fragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TextCoords));
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
 
     // Specular
-    vec3 reflectDir = reflect(-lightDir, norm);
+    vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TextCoords));
+    vec3 specular = light.specular * spec * surface.specular;
 
     // Attenuation
     float distance = length(light.position - FragPos);
@@ -147,4 +210,33 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 
     // Result
     return (ambient + diffuse + specular);
-}
\ No newline at end of file
+}
+
+#ifdef PROBE_LIGHTING
+vec3 CalcProbeIrradiance(vec3 normal, vec3 fragPos)
+{
+    // Probe cell coordinates, nudged off the surface so probes behind it weigh less. Clamping to the outer probes keeps
+    // the filter inside each slot.
+    vec3 cell = clamp((fragPos + normal * (0.25 * probeGridSpacing) - probeGridMin) / probeGridSpacing, vec3(0.0), probeGridCounts - 1.0);
+    vec3 uvw = (cell + 0.5) / vec3(probeGridCounts.xy, probeGridCounts.z * 7.0);
+    float slot = 1.0 / 7.0;
+    vec4 c0 = texture(probeGrid, uvw);
+    vec4 c1 = texture(probeGrid, uvw + vec3(0.0, 0.0, slot));
+    vec4 c2 = texture(probeGrid, uvw + vec3(0.0, 0.0, 2.0 * slot));
+    vec4 c3 = texture(probeGrid, uvw + vec3(0.0, 0.0, 3.0 * slot));
+    vec4 c4 = texture(probeGrid, uvw + vec3(0.0, 0.0, 4.0 * slot));
+    vec4 c5 = texture(probeGrid, uvw + vec3(0.0, 0.0, 5.0 * slot));
+    vec4 c6 = texture(probeGrid, uvw + vec3(0.0, 0.0, 6.0 * slot));
+
+    // Coefficients are already convolved with the clamped cosine, evaluating the basis at the normal gives irradiance
+    vec3 n = normal;
+    vec3 irradiance = 0.282095 * c0.rgb
+                    + 0.488603 * (n.y * vec3(c0.a, c1.rg) + n.z * vec3(c1.ba, c2.r) + n.x * c2.gba)
+                    + 1.092548 * (n.x * n.y * c3.rgb + n.y * n.z * vec3(c3.a, c4.rg) + n.x * n.z * c5.gba)
+                    + 0.315392 * (3.0 * n.z * n.z - 1.0) * vec3(c4.ba, c5.r)
+                    + 0.546274 * (n.x * n.x - n.y * n.y) * c6.rgb;
+
+    // L2 rings slightly below zero opposite bright light
+    return max(irradiance, 0.0);
+}
+#endif
@@ -0,0 +1,418 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "asset_io.h"
+#include "trace.h"
+
+// Completion of the no-op destroy() submits to wake the reaper, never a valid ticket
+const unsigned long long ASSET_IO_STOP = ASSET_READ_NONE;
+
+static int ringSetup(unsigned int entries, struct io_uring_params *params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ringEnter(int ring, unsigned int submitCount, unsigned int waitCount, unsigned int flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring, submitCount, waitCount, flags, NULL, 0));
+}
+
+static double millisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Uses io_uring when the kernel allows it, otherwise starts threadCount pread workers
+void AssetReader::init(unsigned int threadCount)
+{
+    isStopping = false;
+    if (initRing())
+    {
+        threads.emplace_back(&AssetReader::reapLoop, this);
+        return;
+    }
+    if (threadCount == 0)
+        threadCount = std::min(std::max(std::thread::hardware_concurrency(), 2u), 8u);
+    for (unsigned int i = 0; i < threadCount; i++)
+        threads.emplace_back(&AssetReader::preadLoop, this);
+}
+
+// Waits for every read, then stops the threads and tears the ring down
+void AssetReader::destroy()
+{
+    if (threads.empty())
+        return;
+    waitAll();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+        if (ring >= 0)
+        {
+            unsigned int tail = *submissionTail;
+            unsigned int index = tail & *submissionMask;
+            struct io_uring_sqe *entry = static_cast<struct io_uring_sqe*>(entries) + index;
+            std::memset(entry, 0, sizeof(*entry));
+            entry->opcode = IORING_OP_NOP;
+            entry->user_data = ASSET_IO_STOP;
+            submissionArray[index] = index;
+            __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+            while (ringEnter(ring, 1, 0, 0) < 0 && errno == EINTR)
+                ;
+        }
+    }
+    workCondition.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+    threads.clear();
+    destroyRing();
+    reads.clear();
+    queued.clear();
+    pending.clear();
+    inFlight = outstanding = 0;
+    firstSubmitTime = lastDoneTime = std::chrono::steady_clock::time_point();
+}
+
+bool AssetReader::initRing()
+{
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring = ringSetup(ASSET_IO_QUEUE_DEPTH, &params);
+    if (ring < 0)
+        return false;
+
+    submissionMappingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    completionMappingBytes = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool isSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (isSingleMapping)
+        submissionMappingBytes = completionMappingBytes = std::max(submissionMappingBytes, completionMappingBytes);
+    submissionMapping = mmap(NULL, submissionMappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    if (submissionMapping == MAP_FAILED)
+        submissionMapping = nullptr;
+    completionMapping = isSingleMapping ? submissionMapping :
+        mmap(NULL, completionMappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    if (completionMapping == MAP_FAILED)
+        completionMapping = nullptr;
+    entryMappingBytes = params.sq_entries * sizeof(struct io_uring_sqe);
+    entryMapping = mmap(NULL, entryMappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+    if (entryMapping == MAP_FAILED)
+        entryMapping = nullptr;
+    if (!submissionMapping || !completionMapping || !entryMapping)
+    {
+        destroyRing();
+        return false;
+    }
+
+    unsigned char *submission = static_cast<unsigned char*>(submissionMapping);
+    unsigned char *completion = static_cast<unsigned char*>(completionMapping);
+    submissionHead = reinterpret_cast<unsigned int*>(submission + params.sq_off.head);
+    submissionTail = reinterpret_cast<unsigned int*>(submission + params.sq_off.tail);
+    submissionMask = reinterpret_cast<unsigned int*>(submission + params.sq_off.ring_mask);
+    submissionArray = reinterpret_cast<unsigned int*>(submission + params.sq_off.array);
+    completionHead = reinterpret_cast<unsigned int*>(completion + params.cq_off.head);
+    completionTail = reinterpret_cast<unsigned int*>(completion + params.cq_off.tail);
+    completionMask = reinterpret_cast<unsigned int*>(completion + params.cq_off.ring_mask);
+    completions = completion + params.cq_off.cqes;
+    entries = entryMapping;
+    return true;
+}
+
+void AssetReader::destroyRing()
+{
+    if (entryMapping)
+        munmap(entryMapping, entryMappingBytes);
+    if (completionMapping && completionMapping != submissionMapping)
+        munmap(completionMapping, completionMappingBytes);
+    if (submissionMapping)
+        munmap(submissionMapping, submissionMappingBytes);
+    if (ring >= 0)
+        close(ring);
+    ring = -1;
+    submissionMapping = completionMapping = entryMapping = nullptr;
+    entries = completions = nullptr;
+}
+
+// Opens and sizes the file now so the buffer can be resized, the read itself waits for submit()
+unsigned int AssetReader::read(const char *path, std::vector<unsigned char> &buffer)
+{
+    int file = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (file >= 0 && fstat(file, &status) != 0)
+    {
+        close(file);
+        file = -1;
+    }
+    buffer.resize(file >= 0 ? static_cast<size_t>(status.st_size) : 0);
+    return queue(path, file, buffer.data(), buffer.size());
+}
+
+unsigned int AssetReader::read(const char *path, std::string &buffer)
+{
+    int file = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (file >= 0 && fstat(file, &status) != 0)
+    {
+        close(file);
+        file = -1;
+    }
+    buffer.resize(file >= 0 ? static_cast<size_t>(status.st_size) : 0);
+    return queue(path, file, reinterpret_cast<unsigned char*>(&buffer[0]), buffer.size());
+}
+
+unsigned int AssetReader::queue(const char *path, int file, unsigned char *data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned int ticket = static_cast<unsigned int>(reads.size());
+    reads.emplace_back();
+    AssetRead &read = reads.back();
+    read.path = path;
+    read.file = file;
+    read.data = data;
+    read.size = size;
+    outstanding++;
+    if (file < 0 || size == 0)
+    {
+        // Missing files are common (cooked textures that were never built), so they fail quietly
+        read.submitTime = std::chrono::steady_clock::now();
+        complete(ticket, file < 0 ? -ENOENT : 0);
+    }
+    else
+        queued.push_back(ticket);
+    return ticket;
+}
+
+// Hands every queued read to the kernel or the pread threads in one go
+void AssetReader::submit()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    submitQueued();
+}
+
+void AssetReader::submitQueued()
+{
+    if (queued.empty())
+        return;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (firstSubmitTime == std::chrono::steady_clock::time_point())
+        firstSubmitTime = now;
+    for (unsigned int ticket : queued)
+    {
+        reads[ticket].submitTime = now;
+        pending.push_back(ticket);
+    }
+    queued.clear();
+    if (ring >= 0)
+        fillRing();
+    else
+        workCondition.notify_all();
+}
+
+// Moves pending reads into free submission slots, called with the mutex held
+void AssetReader::fillRing()
+{
+    unsigned int count = 0;
+    while (!pending.empty() && inFlight < ASSET_IO_QUEUE_DEPTH)
+    {
+        unsigned int ticket = pending.front();
+        pending.pop_front();
+        AssetRead &read = reads[ticket];
+        read.vector.iov_base = read.data + read.offset;
+        read.vector.iov_len = read.size - read.offset;
+
+        unsigned int tail = *submissionTail;
+        unsigned int index = tail & *submissionMask;
+        struct io_uring_sqe *entry = static_cast<struct io_uring_sqe*>(entries) + index;
+        std::memset(entry, 0, sizeof(*entry));
+        entry->opcode = IORING_OP_READV;
+        entry->fd = read.file;
+        entry->addr = reinterpret_cast<unsigned long long>(&read.vector);
+        entry->len = 1;
+        entry->off = read.offset;
+        entry->user_data = ticket;
+        submissionArray[index] = index;
+        __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+        inFlight++;
+        count++;
+    }
+
+    while (count > 0)
+    {
+        int submitted = ringEnter(ring, count, 0, 0);
+        if (submitted < 0 && errno == EINTR)
+            continue;
+        if (submitted < 0)
+        {
+            std::cout << "ERROR::ASSET_IO::SUBMIT_FAILED: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        count -= std::min(count, static_cast<unsigned int>(submitted));
+    }
+}
+
+// Short reads go back to the front of the queue, called with the mutex held
+void AssetReader::complete(unsigned int ticket, long result)
+{
+    AssetRead &read = reads[ticket];
+    if (result == -EINTR || result == -EAGAIN)
+    {
+        pending.push_front(ticket);
+        return;
+    }
+    if (result > 0)
+    {
+        read.offset += static_cast<size_t>(result);
+        if (read.offset < read.size)
+        {
+            pending.push_front(ticket);
+            return;
+        }
+    }
+    else if (result < 0 || read.size > 0)
+    {
+        if (result != -ENOENT)
+            std::cout << "ERROR::ASSET_IO::READ_FAILED: " << read.path << ": " << (result < 0 ? std::strerror(-result) : "truncated") << std::endl;
+        read.isFailed = true;
+    }
+
+    if (read.file >= 0)
+        close(read.file);
+    read.file = -1;
+    lastDoneTime = std::chrono::steady_clock::now();
+    read.readMs = millisecondsBetween(read.submitTime, lastDoneTime);
+    read.isDone = true;
+    outstanding--;
+}
+
+// Submits the read if it is still queued, true when the whole file arrived
+bool AssetReader::wait(unsigned int ticket)
+{
+    if (ticket == ASSET_READ_NONE)
+        return false;
+    std::unique_lock<std::mutex> lock(mutex);
+    submitQueued();
+    doneCondition.wait(lock, [this, ticket] { return reads[ticket].isDone; });
+    return !reads[ticket].isFailed;
+}
+
+void AssetReader::waitAll()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    submitQueued();
+    doneCondition.wait(lock, [this] { return outstanding == 0; });
+}
+
+bool AssetReader::isUsingRing() const
+{
+    return ring >= 0;
+}
+
+void AssetReader::reapLoop()
+{
+    while (true)
+    {
+        if (ringEnter(ring, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+            std::cout << "ERROR::ASSET_IO::WAIT_FAILED: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        bool isStopped = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            unsigned int head = *completionHead;
+            unsigned int tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; head++)
+            {
+                const struct io_uring_cqe *completion = static_cast<const struct io_uring_cqe*>(completions) + (head & *completionMask);
+                if (completion->user_data == ASSET_IO_STOP)
+                {
+                    isStopped = true;
+                    continue;
+                }
+                inFlight--;
+                complete(static_cast<unsigned int>(completion->user_data), completion->res);
+            }
+            __atomic_store_n(completionHead, head, __ATOMIC_RELEASE);
+            fillRing();
+        }
+        doneCondition.notify_all();
+        if (isStopped)
+            return;
+    }
+}
+
+void AssetReader::preadLoop()
+{
+    while (true)
+    {
+        unsigned int ticket;
+        int file;
+        unsigned char *data;
+        size_t size, offset;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workCondition.wait(lock, [this] { return isStopping || !pending.empty(); });
+            if (isStopping)
+                return;
+            ticket = pending.front();
+            pending.pop_front();
+            file = reads[ticket].file;
+            data = reads[ticket].data;
+            size = reads[ticket].size;
+            offset = reads[ticket].offset;
+        }
+
+        TraceScope scope("asset read");
+        long result = 0;
+        while (offset + result < size)
+        {
+            ssize_t count = pread(file, data + offset + result, size - offset - result, static_cast<off_t>(offset + result));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0)
+            {
+                result = count < 0 ? -errno : 0;
+                break;
+            }
+            result += count;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            complete(ticket, result);
+        }
+        doneCondition.notify_all();
+    }
+}
+
+// Per file latency from submission to completion, overlapped reads make the wall time far less than the sum
+void AssetReader::printStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t totalBytes = 0;
+    double summedMs = 0.0;
+    for (const AssetRead &read : reads)
+    {
+        totalBytes += read.isFailed ? 0 : read.size;
+        summedMs += read.readMs;
+    }
+    std::cout << "Asset reads: " << reads.size() << " files, " << std::fixed << std::setprecision(2)
+              << totalBytes / 1024.0 << " KiB via " << (ring >= 0 ? "io_uring" : "pread threads") << ", "
+              << (reads.empty() ? 0.0 : millisecondsBetween(firstSubmitTime, lastDoneTime)) << " ms wall, "
+              << summedMs << " ms summed" << std::endl;
+    for (const AssetRead &read : reads)
+    {
+        std::cout << "    " << read.path << ": ";
+        if (read.isFailed)
+            std::cout << "failed" << std::endl;
+        else
+            std::cout << read.size / 1024.0 << " KiB in " << read.readMs << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef ASSET_IO_H
+#define ASSET_IO_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/uio.h>
+
+// Reads in flight at once, also the io_uring submission queue size
+const unsigned int ASSET_IO_QUEUE_DEPTH = 64;
+
+// Returned for reads that were never queued, waiting on it fails immediately
+const unsigned int ASSET_READ_NONE = ~0u;
+
+// Batched whole-file reads straight into caller buffers. Files are opened and sized when queued, submit() hands every
+// queued read to io_uring at once, or to a pool of pread threads when the kernel has no io_uring.
+// read, submit and wait may be called from any thread. Buffers must stay alive and unmoved until their read is waited on.
+class AssetReader
+{
+    public:
+
+    // Methods
+    void init(unsigned int threadCount = 0);
+    void destroy();
+    unsigned int read(const char *path, std::vector<unsigned char> &buffer);
+    unsigned int read(const char *path, std::string &buffer);
+    void submit();
+    bool wait(unsigned int ticket);
+    void waitAll();
+    bool isUsingRing() const;
+    void printStats() const;
+
+    private:
+
+    struct AssetRead
+    {
+        std::string path;
+        int file = -1;
+        unsigned char *data = nullptr;
+        size_t size = 0;
+        size_t offset = 0;     // Bytes read so far, short reads are resubmitted from here
+        struct iovec vector;
+        bool isDone = false;
+        bool isFailed = false;
+        std::chrono::steady_clock::time_point submitTime;
+        double readMs = 0.0;
+    };
+
+    // io_uring, set up with raw syscalls
+    int ring = -1;
+    void *submissionMapping = nullptr;
+    void *completionMapping = nullptr;
+    void *entryMapping = nullptr;
+    size_t submissionMappingBytes = 0;
+    size_t completionMappingBytes = 0;
+    size_t entryMappingBytes = 0;
+    unsigned int *submissionHead = nullptr;
+    unsigned int *submissionTail = nullptr;
+    unsigned int *submissionMask = nullptr;
+    unsigned int *submissionArray = nullptr;
+    unsigned int *completionHead = nullptr;
+    unsigned int *completionTail = nullptr;
+    unsigned int *completionMask = nullptr;
+    void *entries = nullptr;
+    void *completions = nullptr;
+
+    mutable std::mutex mutex;
+    std::condition_variable workCondition;
+    std::condition_variable doneCondition;
+    std::deque<AssetRead> reads;           // Indexed by ticket, a deque so records never move
+    std::deque<unsigned int> queued;       // Opened, waiting for submit
+    std::deque<unsigned int> pending;      // Submitted, waiting for a ring slot or a pread thread
+    std::vector<std::thread> threads;      // Completion reaper with a ring, pread workers without
+    unsigned int inFlight = 0;
+    unsigned int outstanding = 0;
+    bool isStopping = false;
+    std::chrono::steady_clock::time_point firstSubmitTime;
+    std::chrono::steady_clock::time_point lastDoneTime;
+
+    bool initRing();
+    void destroyRing();
+    unsigned int queue(const char *path, int file, unsigned char *data, size_t size);
+    void submitQueued();
+    void fillRing();
+    void complete(unsigned int ticket, long result);
+    void reapLoop();
+    void preadLoop();
+};
+#endif
@@ -0,0 +1,155 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "asset_pack.h"
+#include "image_allocator.h"
+
+const char ASSET_PACK_MAGIC[8] = { 'L', 'O', 'G', 'L', 'P', 'A', 'C', 'K' };
+
+// Maps the whole file and checks every entry lies inside it, so find() never has to
+bool AssetPack::open(const char *path)
+{
+    close();
+    int file = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+        return false;
+    struct stat status;
+    void *view = MAP_FAILED;
+    if (fstat(file, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(AssetPackHeader))
+        view = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED)
+    {
+        std::cout << "ERROR::ASSET_PACK::FAILED_TO_MAP: " << path << std::endl;
+        return false;
+    }
+    mapping = view;
+    mappingBytes = status.st_size;
+
+    const unsigned char *bytes = static_cast<const unsigned char*>(mapping);
+    const AssetPackHeader *header = static_cast<const AssetPackHeader*>(mapping);
+    bool isValid = std::memcmp(header->magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC)) == 0 && header->version == ASSET_PACK_VERSION &&
+        header->tocOffset % ASSET_PACK_ALIGNMENT == 0 && header->tocOffset <= mappingBytes &&
+        header->entryCount <= (mappingBytes - header->tocOffset) / sizeof(AssetPackEntry) &&
+        header->namesOffset >= header->tocOffset + header->entryCount * sizeof(AssetPackEntry) && header->namesOffset <= mappingBytes;
+    if (isValid)
+    {
+        entries = reinterpret_cast<const AssetPackEntry*>(bytes + header->tocOffset);
+        names = reinterpret_cast<const char*>(bytes + header->namesOffset);
+        size_t namesBytes = mappingBytes - header->namesOffset;
+        // find() hands out uncompressed entries with their decoded size, so that has to be the stored size too
+        for (uint32_t i = 0; i < header->entryCount && isValid; i++)
+            isValid = entries[i].nameOffset + static_cast<size_t>(entries[i].nameLength) <= namesBytes &&
+                      entries[i].offset <= mappingBytes && entries[i].storedSize <= mappingBytes - entries[i].offset &&
+                      (entries[i].compression != ASSET_COMPRESSION_NONE || entries[i].size == entries[i].storedSize);
+    }
+    if (!isValid)
+    {
+        std::cout << "ERROR::ASSET_PACK::INVALID_FILE: " << path << std::endl;
+        close();
+        return false;
+    }
+    entryCount = header->entryCount;
+    return true;
+}
+
+void AssetPack::close()
+{
+    if (mapping)
+        munmap(mapping, mappingBytes);
+    mapping = nullptr;
+    mappingBytes = 0;
+    entries = nullptr;
+    names = nullptr;
+    entryCount = 0;
+}
+
+bool AssetPack::isOpen() const
+{
+    return mapping != nullptr;
+}
+
+// Binary search over the sorted table, leading "./" and "../" are dropped so build-directory paths match root names
+bool AssetPack::find(const char *path, AssetSpan &span) const
+{
+    if (!mapping)
+        return false;
+    std::string_view name(path);
+    while (true)
+    {
+        if (name.compare(0, 2, "./") == 0)
+            name.remove_prefix(2);
+        else if (name.compare(0, 3, "../") == 0)
+            name.remove_prefix(3);
+        else
+            break;
+    }
+
+    const AssetPackEntry *end = entries + entryCount;
+    const AssetPackEntry *entry = std::lower_bound(entries, end, name, [this](const AssetPackEntry &candidate, std::string_view key) {
+        return std::string_view(names + candidate.nameOffset, candidate.nameLength) < key;
+    });
+    if (entry == end || std::string_view(names + entry->nameOffset, entry->nameLength) != name)
+        return false;
+    if (entry->compression != ASSET_COMPRESSION_NONE)
+    {
+        std::cout << "ERROR::ASSET_PACK::UNSUPPORTED_COMPRESSION: " << name << std::endl;
+        return false;
+    }
+    span.data = static_cast<const unsigned char*>(mapping) + entry->offset;
+    span.size = entry->size;
+    span.hash = entry->hash;
+    return true;
+}
+
+unsigned int AssetPack::getEntryCount() const
+{
+    return entryCount;
+}
+
+uint64_t hashAssetBytes(const unsigned char *bytes, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string defaultAssetPackPath()
+{
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+        return ASSET_PACK_FILE_NAME;
+    std::string executable(path, length);
+    size_t slash = executable.rfind('/');
+    return executable.substr(0, slash + 1) + ASSET_PACK_FILE_NAME;
+}
+
+unsigned char *decodeAssetImage(const AssetPack *pack, const char *path, int *width, int *height, int *components,
+                                int desiredComponents)
+{
+    AssetSpan span;
+    if (pack && pack->find(path, span))
+        return decodeImage(span.data, span.size, width, height, components, desiredComponents);
+    return decodeImageFile(path, width, height, components, desiredComponents);
+}
+
+// KTX2 images own their bytes, so a packed file is copied once before parsing
+bool readAssetKTX2(const AssetPack *pack, const char *path, KTX2Image &image)
+{
+    AssetSpan span;
+    if (!pack || !pack->find(path, span))
+        return readKTX2(path, image);
+    image.data.assign(span.data, span.data + span.size);
+    return parseKTX2(path, image);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ktx2.h"
+
+// Written by the pack_assets target next to the executable, see tools/asset_pack.cpp
+const char* const ASSET_PACK_FILE_NAME = "assets.pack";
+const uint32_t ASSET_PACK_VERSION = 1;
+
+// The table of contents and every entry start on this boundary
+const size_t ASSET_PACK_ALIGNMENT = 64;
+
+// Per-entry storage, compressed ids are reserved for codecs the build does not ship yet
+enum AssetCompression : uint32_t
+{
+    ASSET_COMPRESSION_NONE = 0,
+    ASSET_COMPRESSION_LZ4 = 1,
+    ASSET_COMPRESSION_ZSTD = 2
+};
+
+// File layout, native byte order: header, table of contents sorted by name, name strings, entry data
+struct AssetPackHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t tocOffset;
+    uint64_t namesOffset;
+};
+
+struct AssetPackEntry
+{
+    uint64_t offset;
+    uint64_t size;          // Bytes once decompressed
+    uint64_t storedSize;    // Bytes in the file
+    uint64_t hash;          // hashAssetBytes of the decompressed bytes
+    uint32_t nameOffset;    // Into the name strings, not terminated
+    uint32_t nameLength;
+    uint32_t compression;
+    uint32_t reserved;
+};
+
+extern const char ASSET_PACK_MAGIC[8];
+
+// Bytes of one entry inside the mapping, valid until the pack is closed
+struct AssetSpan
+{
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    uint64_t hash = 0;
+};
+
+// Read-only view of an asset pack, mapped once. Entries are named relative to the project root ("vert.glsl",
+// "assets/container2.png"), find() also accepts the loose paths the renderer uses from the build directory.
+class AssetPack
+{
+    public:
+
+    // Methods
+    bool open(const char *path);
+    void close();
+    bool isOpen() const;
+    bool find(const char *path, AssetSpan &span) const;
+    unsigned int getEntryCount() const;
+
+    private:
+
+    void *mapping = nullptr;
+    size_t mappingBytes = 0;
+    const AssetPackEntry *entries = nullptr;
+    const char *names = nullptr;
+    unsigned int entryCount = 0;
+};
+
+// FNV-1a, shared by the pack and the texture loader so content hashes agree whichever way a file was read
+uint64_t hashAssetBytes(const unsigned char *bytes, size_t size);
+
+// Path of ASSET_PACK_FILE_NAME beside the running executable, independent of the working directory
+std::string defaultAssetPackPath();
+
+// Pack entry when pack is open and has path, the loose file otherwise
+unsigned char *decodeAssetImage(const AssetPack *pack, const char *path, int *width, int *height, int *components,
+                                int desiredComponents);
+bool readAssetKTX2(const AssetPack *pack, const char *path, KTX2Image &image);
+#endif
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include "benchmark.h"
+#include "gl_instrumentation.h"
+
+Benchmark::Benchmark(BenchmarkSettings settings) : settings(settings)
+{
+    cpuFrameTimes.reserve(settings.measuredFrames);
+    gpuFrameTimes.reserve(settings.measuredFrames);
+    frameStats.reserve(settings.measuredFrames);
+    std::fill(queryFrames, queryFrames + GPU_QUERY_LATENCY, -1);
+}
+
+// Requires a current GL context
+void Benchmark::init()
+{
+    glGenQueries(GPU_QUERY_LATENCY, queries);
+    const GLubyte *rendererString = glGetString(GL_RENDERER);
+    renderer = rendererString ? reinterpret_cast<const char*>(rendererString) : "unknown";
+}
+
+void Benchmark::beginFrame()
+{
+    frameStart = std::chrono::steady_clock::now();
+
+    // Reuse the oldest query slot, its result is almost always available by now
+    unsigned int slot = frameIndex % GPU_QUERY_LATENCY;
+    resolveQuery(slot);
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+    queryFrames[slot] = static_cast<int>(frameIndex);
+}
+
+void Benchmark::endFrame()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - frameStart;
+
+    if (!isWarmingUp() && !isFinished())
+    {
+        cpuFrameTimes.push_back(cpuTime.count());
+        frameStats.push_back(renderStats);
+    }
+    frameIndex++;
+
+    // Drain outstanding queries once the last frame is in
+    if (isFinished())
+        drainQueries();
+}
+
+bool Benchmark::isFinished() const
+{
+    return frameIndex >= settings.warmupFrames + settings.measuredFrames;
+}
+
+bool Benchmark::isWarmingUp() const
+{
+    return frameIndex < settings.warmupFrames;
+}
+
+void Benchmark::resolveQuery(unsigned int slot)
+{
+    if (queryFrames[slot] < 0)
+        return;
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsed);
+
+    // Slots resolve in frame order, so appending keeps each time at its frame's index
+    int measuredIndex = queryFrames[slot] - static_cast<int>(settings.warmupFrames);
+    if (measuredIndex >= 0 && measuredIndex < static_cast<int>(settings.measuredFrames))
+        gpuFrameTimes.push_back(elapsed / 1e6);
+    queryFrames[slot] = -1;
+}
+
+// Resolves the queries still in flight, oldest first, and releases them
+void Benchmark::drainQueries()
+{
+    if (!queries[0])
+        return;
+    for (unsigned int i = 0; i < GPU_QUERY_LATENCY; i++)
+        resolveQuery((frameIndex + i) % GPU_QUERY_LATENCY);
+    glDeleteQueries(GPU_QUERY_LATENCY, queries);
+    queries[0] = 0;
+}
+
+BenchmarkSummary Benchmark::summarize(std::vector<double> values)
+{
+    BenchmarkSummary summary;
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    size_t count = values.size();
+
+    // Nearest-rank percentile
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * count));
+        return values[std::min(std::max<size_t>(rank, 1), count) - 1];
+    };
+
+    double total = 0.0;
+    for (double value : values)
+        total += value;
+
+    size_t lowCount = std::max<size_t>(count / 100, 1);
+    double lowTotal = 0.0;
+    for (size_t i = count - lowCount; i < count; i++)
+        lowTotal += values[i];
+
+    summary.mean = total / count;
+    summary.median = count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) * .5;
+    summary.p95 = percentile(95.0);
+    summary.p99 = percentile(99.0);
+    summary.max = values.back();
+    summary.low1 = lowTotal / lowCount;
+    return summary;
+}
+
+// Writes <prefix>.csv and <prefix>.json summaries plus <prefix>_frames.csv with raw samples
+bool Benchmark::writeResults()
+{
+    // A run closed early still has its last frames in flight, only frames with a resolved time count
+    drainQueries();
+
+    struct Metric
+    {
+        const char *name;
+        std::vector<double> values;
+    };
+
+    std::vector<Metric> metrics = {
+        { "cpu_frame_ms", cpuFrameTimes },
+        { "gpu_frame_ms", gpuFrameTimes }
+    };
+
+    // Without GL_INSTRUMENTATION nothing counts the calls, leave the counters out rather than report zeros
+    if (isGLInstrumentationInstalled())
+    {
+        std::vector<Metric> counters = {
+            { "draw_calls", {} },
+            { "program_binds", {} },
+            { "texture_binds", {} },
+            { "vertex_array_binds", {} },
+            { "uniform_calls", {} },
+            { "buffer_uploads", {} },
+            { "buffer_upload_bytes", {} },
+            { "texture_uploads", {} },
+            { "texture_upload_bytes", {} }
+        };
+        for (const RenderStats &stats : frameStats)
+        {
+            counters[0].values.push_back(stats.drawCalls);
+            counters[1].values.push_back(stats.programBinds);
+            counters[2].values.push_back(stats.textureBinds);
+            counters[3].values.push_back(stats.vertexArrayBinds);
+            counters[4].values.push_back(stats.uniformCalls);
+            counters[5].values.push_back(stats.bufferUploads);
+            counters[6].values.push_back(stats.bufferUploadBytes);
+            counters[7].values.push_back(stats.textureUploads);
+            counters[8].values.push_back(stats.textureUploadBytes);
+        }
+        metrics.insert(metrics.end(), counters.begin(), counters.end());
+    }
+
+    std::ofstream csv(settings.outputPrefix + ".csv");
+    std::ofstream json(settings.outputPrefix + ".json");
+    std::ofstream frames(settings.outputPrefix + "_frames.csv");
+    if (!csv || !json || !frames)
+    {
+        std::cout << "ERROR::BENCHMARK::FAILED_TO_OPEN_OUTPUT: " << settings.outputPrefix << std::endl;
+        return false;
+    }
+
+    csv << std::fixed << std::setprecision(4);
+    json << std::fixed << std::setprecision(4);
+    frames << std::fixed << std::setprecision(4);
+
+    csv << "metric,mean,median,p95,p99,max,low1\n";
+    json << "{\n"
+         << "  \"renderer\": \"" << renderer << "\",\n"
+         << "  \"warmup_frames\": " << settings.warmupFrames << ",\n"
+         << "  \"measured_frames\": " << cpuFrameTimes.size() << ",\n"
+         << "  \"metrics\": {\n";
+    for (size_t i = 0; i < metrics.size(); i++)
+    {
+        BenchmarkSummary s = summarize(metrics[i].values);
+        csv << metrics[i].name << ',' << s.mean << ',' << s.median << ',' << s.p95 << ',' << s.p99 << ',' << s.max << ',' << s.low1 << '\n';
+        json << "    \"" << metrics[i].name << "\": { "
+             << "\"mean\": " << s.mean << ", \"median\": " << s.median << ", \"p95\": " << s.p95 << ", "
+             << "\"p99\": " << s.p99 << ", \"max\": " << s.max << ", \"low1\": " << s.low1 << " }"
+             << (i + 1 < metrics.size() ? ",\n" : "\n");
+    }
+    json << "  }\n}\n";
+
+    // Raw per-frame samples for hitch analysis
+    frames << "frame";
+    for (const Metric &metric : metrics)
+        frames << ',' << metric.name;
+    frames << '\n';
+    for (size_t frame = 0; frame < cpuFrameTimes.size(); frame++)
+    {
+        frames << frame;
+        for (const Metric &metric : metrics)
+        {
+            frames << ',';
+            if (frame < metric.values.size())
+                frames << metric.values[frame];
+        }
+        frames << '\n';
+    }
+
+    std::cout << "Benchmark: " << cpuFrameTimes.size() << " frames on " << renderer
+              << ", results written to " << settings.outputPrefix << ".{csv,json}" << std::endl;
+    return true;
+}
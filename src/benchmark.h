@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "glad/glad.h"
+#include "render_stats.h"
+
+// Frames a timer query is kept in flight before its result is read back
+const unsigned int GPU_QUERY_LATENCY = 4;
+
+struct BenchmarkSettings
+{
+    unsigned int warmupFrames = 100;
+    unsigned int measuredFrames = 1000;
+    std::string outputPrefix = "benchmark";
+};
+
+struct BenchmarkSummary
+{
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double low1 = 0.0;    // Mean of the slowest 1% of frames
+};
+
+class Benchmark
+{
+    public:
+
+    BenchmarkSettings settings;
+
+    // Constructors
+    Benchmark(BenchmarkSettings settings);
+
+    // Methods
+    void init();
+    void beginFrame();
+    void endFrame();
+    bool isFinished() const;
+    bool isWarmingUp() const;
+    bool writeResults();
+
+    static BenchmarkSummary summarize(std::vector<double> values);
+
+    private:
+
+    unsigned int frameIndex = 0;
+    unsigned int queries[GPU_QUERY_LATENCY] = {};
+    int queryFrames[GPU_QUERY_LATENCY];
+    std::string renderer;
+    std::chrono::steady_clock::time_point frameStart;
+
+    // Samples of measured frames, GPU times are appended as their queries resolve so they can trail the CPU ones
+    std::vector<double> cpuFrameTimes;
+    std::vector<double> gpuFrameTimes;
+    std::vector<RenderStats> frameStats;
+
+    void resolveQuery(unsigned int slot);
+    void drainQueries();
+};
+#endif
@@ -1,6 +1,9 @@
 #include <iostream>
 #include "camera.h"
 
+// Sine of the 89 degree pitch limit, used to constrain pitch without converting back to angles
+const float MAX_PITCH_SIN = 0.99984770f;
+
 Camera::Camera(glm::vec3 position, glm::vec3 front, glm::vec3 up) : position(position), front(front), up(up), worldUp(up)
 {
     updateCameraVectors();
@@ -39,6 +42,12 @@ void Camera::processMouseMovement(float xoffset, float yoffset, GLboolean constr
     xoffset *= mouseSensitivity;
     yoffset *= mouseSensitivity;
 
+    if (orientationMode == QUATERNION)
+    {
+        rotate(xoffset, yoffset, constraintPitch);
+        return;
+    }
+
     yaw += xoffset;
     pitch += yoffset;
 
@@ -64,12 +73,29 @@ void Camera::processMouseScroll(float yoffset)
 void Camera::lookAtPosition(glm::vec3 position)
 {
     glm::vec3 lookDir = glm::normalize(position - this->position);
+    if (orientationMode == QUATERNION)
+    {
+        hasOrientationTarget = false;
+        orientation = lookRotation(lookDir);
+        updateCameraVectors();
+        return;
+    }
+
     this->pitch = glm::degrees(glm::asin(lookDir.y));
     this->yaw = glm::degrees(glm::atan(lookDir.z, lookDir.x));
     
     updateCameraVectors();
 }
 
+void Camera::setEulerAngles(float yaw, float pitch)
+{
+    setOrientationMode(EULER);
+    this->yaw = yaw;
+    this->pitch = pitch;
+
+    updateCameraVectors();
+}
+
 glm::mat4 Camera::getViewMatrix() const
 {
     glm::mat4 translation = glm::mat4(
@@ -100,8 +126,140 @@ float Camera::getSpeed() const
         return movementSpeed;
 }
 
+void Camera::setOrientationMode(Camera_Orientation mode)
+{
+    if (mode == orientationMode)
+        return;
+
+    if (mode == QUATERNION)
+        updateOrientationFromVectors();
+    else
+        syncEulerAngles();
+
+    hasOrientationTarget = false;
+    orientationMode = mode;
+    updateCameraVectors();
+}
+
+Camera_Orientation Camera::getOrientationMode() const
+{
+    return orientationMode;
+}
+
+// Apply a small yaw/pitch increment (in degrees) to the quaternion without any trig.
+// The half-angle is used directly as the vector part, which is exact up to the
+// small-angle approximation and is renormalized every step.
+void Camera::rotate(float yawOffset, float pitchOffset, GLboolean constraintPitch)
+{
+    setOrientationMode(QUATERNION);
+
+    // Yaw around world up (applied in world space)
+    glm::vec3 yawAxis = worldUp * (-glm::radians(yawOffset) * .5f);
+    glm::quat yawRotation = glm::normalize(glm::quat(1.f, yawAxis.x, yawAxis.y, yawAxis.z));
+    orientation = glm::normalize(yawRotation * orientation);
+
+    // Pitch around camera right (applied in camera space)
+    float halfPitch = glm::radians(pitchOffset) * .5f;
+    glm::quat pitchRotation = glm::normalize(glm::quat(1.f, halfPitch, 0.f, 0.f));
+    glm::quat pitched = glm::normalize(orientation * pitchRotation);
+
+    // Reject the pitch step instead of flipping over the pole
+    glm::vec3 pitchedFront = pitched * glm::vec3(0.f, 0.f, -1.f);
+    if (!constraintPitch || glm::abs(glm::dot(pitchedFront, worldUp)) < MAX_PITCH_SIN)
+        orientation = pitched;
+
+    hasOrientationTarget = false;
+    updateCameraVectors();
+}
+
+void Camera::setOrientation(glm::quat orientation)
+{
+    setOrientationMode(QUATERNION);
+    this->orientation = glm::normalize(orientation);
+    hasOrientationTarget = false;
+    updateCameraVectors();
+}
+
+// Slerp from the current orientation to target over duration seconds, advanced by update()
+void Camera::setOrientationTarget(glm::quat target, float duration)
+{
+    if (duration <= 0.f)
+    {
+        setOrientation(target);
+        return;
+    }
+
+    setOrientationMode(QUATERNION);
+    startOrientation = orientation;
+    targetOrientation = glm::normalize(target);
+    targetDuration = duration;
+    targetElapsed = 0.f;
+    hasOrientationTarget = true;
+}
+
+void Camera::setLookAtTarget(glm::vec3 position, float duration)
+{
+    glm::vec3 lookDir = glm::normalize(position - this->position);
+    setOrientationTarget(lookRotation(lookDir), duration);
+}
+
+void Camera::update(float deltaTime)
+{
+    if (!hasOrientationTarget)
+        return;
+
+    targetElapsed += deltaTime;
+    float t = glm::min(targetElapsed / targetDuration, 1.f);
+    orientation = glm::normalize(glm::slerp(startOrientation, targetOrientation, t));
+    if (t >= 1.f)
+        hasOrientationTarget = false;
+
+    updateCameraVectors();
+}
+
+bool Camera::isAnimatingOrientation() const
+{
+    return hasOrientationTarget;
+}
+
+glm::quat Camera::getOrientation() const
+{
+    return orientation;
+}
+
+// Recompute yaw/pitch from the current front vector
+void Camera::syncEulerAngles()
+{
+    pitch = glm::degrees(glm::asin(glm::clamp(front.y, -1.f, 1.f)));
+    yaw = glm::degrees(glm::atan(front.z, front.x));
+}
+
+void Camera::updateOrientationFromVectors()
+{
+    orientation = glm::normalize(glm::quat_cast(glm::mat3(right, up, -front)));
+}
+
+// quatLookAt has no solution when looking along worldUp, the current heading becomes the up axis instead
+glm::quat Camera::lookRotation(glm::vec3 lookDir) const
+{
+    glm::vec3 lookUp = worldUp;
+    if (glm::length(glm::cross(lookDir, worldUp)) < 1e-4f)
+        lookUp = glm::length(glm::cross(lookDir, front)) < 1e-4f ? up : front * -glm::dot(lookDir, worldUp);
+    return glm::quatLookAt(lookDir, lookUp);
+}
+
 void Camera::updateCameraVectors()
 {
+    // Basis vectors are the columns of the rotation matrix, no trig required
+    if (orientationMode == QUATERNION)
+    {
+        glm::mat3 basis = glm::mat3_cast(orientation);
+        right = basis[0];
+        up = basis[1];
+        front = -basis[2];
+        return;
+    }
+
     front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
     front.y = sin(glm::radians(pitch));
     front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
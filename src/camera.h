@@ -6,6 +6,7 @@
 #include "glad/glad.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 enum Camera_Movement
 {
@@ -17,6 +18,12 @@ enum Camera_Movement
     DOWN
 };
 
+enum Camera_Orientation
+{
+    EULER,
+    QUATERNION
+};
+
 class Camera
 {
     public:
@@ -43,10 +50,24 @@ class Camera
     
     // Methods
     void lookAtPosition(glm::vec3 position);
+    void setEulerAngles(float yaw, float pitch);
     glm::mat4 getViewMatrix() const;
     glm::vec3 getFront() const;
     float getSpeed() const;
 
+    // Quaternion orientation
+    // NOTE: In QUATERNION mode yaw/pitch are not kept in sync, call syncEulerAngles() when they are needed
+    void setOrientationMode(Camera_Orientation mode);
+    Camera_Orientation getOrientationMode() const;
+    void rotate(float yawOffset, float pitchOffset, GLboolean constraintPitch = true);
+    void setOrientation(glm::quat orientation);
+    void setOrientationTarget(glm::quat target, float duration);
+    void setLookAtTarget(glm::vec3 position, float duration);
+    void update(float deltaTime);
+    bool isAnimatingOrientation() const;
+    glm::quat getOrientation() const;
+    void syncEulerAngles();
+
     private:
 
     // Camera vectors
@@ -58,8 +79,19 @@ class Camera
     // Properties
     float movementSpeed = 2.5f;
     float maxSpeed = 6.f;
+
+    // Quaternion orientation (unit length, maps camera space -Z onto front), only changed through setOrientationMode
+    Camera_Orientation orientationMode = EULER;
+    glm::quat orientation = glm::quat(1.f, 0.f, 0.f, 0.f);
+    glm::quat startOrientation = glm::quat(1.f, 0.f, 0.f, 0.f);
+    glm::quat targetOrientation = glm::quat(1.f, 0.f, 0.f, 0.f);
+    float targetDuration = 0.f;
+    float targetElapsed = 0.f;
+    bool hasOrientationTarget = false;
     
     // Reconstruct vectors
     void updateCameraVectors();
+    void updateOrientationFromVectors();
+    glm::quat lookRotation(glm::vec3 lookDir) const;
 };
 #endif
\ No newline at end of file
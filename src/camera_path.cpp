@@ -0,0 +1,191 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "camera_path.h"
+
+// Binary layout: header followed by tightly packed frames (28 bytes each)
+const uint32_t CAMERA_PATH_MAGIC = 0x48545043;  // "CPTH"
+const uint32_t CAMERA_PATH_VERSION = 1;
+const size_t CAMERA_PATH_FRAME_BYTES = 28;
+
+struct CameraPathHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    float timestep;
+    uint32_t frameCount;
+};
+
+static float catmullRom(float p0, float p1, float p2, float p3, float t)
+{
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return .5f * ((2.f * p1) + (-p0 + p2) * t + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 + (-p0 + 3.f * p1 - 3.f * p2 + p3) * t3);
+}
+
+void CameraPath::record(Camera &camera, uint32_t inputFlags)
+{
+    if (camera.getOrientationMode() == QUATERNION)
+        camera.syncEulerAngles();
+
+    CameraPathFrame frame;
+    frame.position = camera.position;
+    frame.yaw = camera.yaw;
+    frame.pitch = camera.pitch;
+    frame.fov = camera.fov;
+    frame.inputFlags = inputFlags;
+    frames.push_back(frame);
+}
+
+bool CameraPath::save(const char *path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::CAMERA_PATH::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    CameraPathHeader header = { CAMERA_PATH_MAGIC, CAMERA_PATH_VERSION, timestep, static_cast<uint32_t>(frames.size()) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const CameraPathFrame &frame : frames)
+    {
+        file.write(reinterpret_cast<const char*>(&frame.position.x), sizeof(float) * 3);
+        file.write(reinterpret_cast<const char*>(&frame.yaw), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&frame.pitch), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&frame.fov), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&frame.inputFlags), sizeof(uint32_t));
+    }
+    return static_cast<bool>(file);
+}
+
+bool CameraPath::load(const char *path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    size_t fileBytes = file ? static_cast<size_t>(file.tellg()) : 0;
+    file.seekg(0);
+    CameraPathHeader header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CAMERA_PATH_MAGIC || header.version != CAMERA_PATH_VERSION ||
+        !std::isfinite(header.timestep) || header.timestep <= 0.f)
+    {
+        std::cout << "ERROR::CAMERA_PATH::INVALID_FILE: " << path << std::endl;
+        return false;
+    }
+
+    // The count is only trusted once the file is known to hold that many frames
+    if (header.frameCount == 0 || header.frameCount > (fileBytes - sizeof(header)) / CAMERA_PATH_FRAME_BYTES)
+    {
+        std::cout << "ERROR::CAMERA_PATH::INVALID_FRAME_COUNT: " << path << " claims " << header.frameCount << " frames" << std::endl;
+        return false;
+    }
+
+    timestep = header.timestep;
+    frames.resize(header.frameCount);
+    for (CameraPathFrame &frame : frames)
+    {
+        file.read(reinterpret_cast<char*>(&frame.position.x), sizeof(float) * 3);
+        file.read(reinterpret_cast<char*>(&frame.yaw), sizeof(float));
+        file.read(reinterpret_cast<char*>(&frame.pitch), sizeof(float));
+        file.read(reinterpret_cast<char*>(&frame.fov), sizeof(float));
+        file.read(reinterpret_cast<char*>(&frame.inputFlags), sizeof(uint32_t));
+    }
+    if (!file)
+    {
+        std::cout << "ERROR::CAMERA_PATH::TRUNCATED_FILE: " << path << std::endl;
+        frames.clear();
+        return false;
+    }
+    return true;
+}
+
+// Text keyframes, one per line: time posX posY posZ yaw pitch fov ('#' starts a comment)
+bool CameraPath::loadKeyframes(const char *path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::CAMERA_PATH::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<CameraKeyframe> keyframes;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        CameraKeyframe key;
+        if (stream >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch >> key.fov)
+            keyframes.push_back(key);
+    }
+    if (keyframes.size() < 2)
+    {
+        std::cout << "ERROR::CAMERA_PATH::NEED_AT_LEAST_TWO_KEYFRAMES: " << path << std::endl;
+        return false;
+    }
+
+    return buildFromKeyframes(keyframes);
+}
+
+// Sample a Catmull-Rom spline through the keyframes at the fixed timestep, times must strictly increase
+bool CameraPath::buildFromKeyframes(const std::vector<CameraKeyframe> &keyframes)
+{
+    frames.clear();
+    bool isValid = !keyframes.empty() && std::isfinite(keyframes.front().time);
+    for (size_t i = 1; i < keyframes.size() && isValid; i++)
+        isValid = std::isfinite(keyframes[i].time) && keyframes[i].time > keyframes[i - 1].time;
+    if (!isValid)
+    {
+        std::cout << "ERROR::CAMERA_PATH::KEYFRAME_TIMES_MUST_INCREASE" << std::endl;
+        return false;
+    }
+
+    float duration = keyframes.back().time - keyframes.front().time;
+    size_t frameCount = static_cast<size_t>(duration / timestep) + 1;
+    frames.reserve(frameCount);
+
+    size_t segment = 0;
+    for (size_t i = 0; i < frameCount; i++)
+    {
+        float time = keyframes.front().time + i * timestep;
+        while (segment + 2 < keyframes.size() && time >= keyframes[segment + 1].time)
+            segment++;
+
+        const CameraKeyframe &k0 = keyframes[segment > 0 ? segment - 1 : 0];
+        const CameraKeyframe &k1 = keyframes[segment];
+        const CameraKeyframe &k2 = keyframes[std::min(segment + 1, keyframes.size() - 1)];
+        const CameraKeyframe &k3 = keyframes[std::min(segment + 2, keyframes.size() - 1)];
+
+        float span = k2.time - k1.time;
+        float t = span > 0.f ? glm::clamp((time - k1.time) / span, 0.f, 1.f) : 0.f;
+
+        CameraPathFrame frame;
+        frame.position.x = catmullRom(k0.position.x, k1.position.x, k2.position.x, k3.position.x, t);
+        frame.position.y = catmullRom(k0.position.y, k1.position.y, k2.position.y, k3.position.y, t);
+        frame.position.z = catmullRom(k0.position.z, k1.position.z, k2.position.z, k3.position.z, t);
+        frame.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, t);
+        frame.pitch = catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t);
+        frame.fov = catmullRom(k0.fov, k1.fov, k2.fov, k3.fov, t);
+        frame.inputFlags = 0;
+        frames.push_back(frame);
+    }
+    return true;
+}
+
+void CameraPath::apply(size_t frame, Camera &camera) const
+{
+    const CameraPathFrame &pathFrame = frames[frame];
+    camera.position = pathFrame.position;
+    camera.fov = pathFrame.fov;
+    camera.setEulerAngles(pathFrame.yaw, pathFrame.pitch);
+}
+
+size_t CameraPath::size() const
+{
+    return frames.size();
+}
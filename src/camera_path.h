@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "camera.h"
+
+// Input state bits stored alongside every recorded frame
+enum Camera_Input : uint32_t
+{
+    INPUT_FORWARD      = 1u << 0,
+    INPUT_BACKWARD     = 1u << 1,
+    INPUT_LEFT         = 1u << 2,
+    INPUT_RIGHT        = 1u << 3,
+    INPUT_UP           = 1u << 4,
+    INPUT_DOWN         = 1u << 5,
+    INPUT_SPRINT       = 1u << 6,
+    INPUT_FOCUS        = 1u << 7,
+    INPUT_RESET        = 1u << 8,
+    INPUT_FLASHLIGHT   = 1u << 9    // Flashlight is on this frame
+};
+
+struct CameraPathFrame
+{
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+    float fov;
+    uint32_t inputFlags;
+};
+
+struct CameraKeyframe
+{
+    float time;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+    float fov;
+};
+
+class CameraPath
+{
+    public:
+
+    // Simulated seconds between frames during replay
+    float timestep = 1.f / 60.f;
+    std::vector<CameraPathFrame> frames;
+
+    // Recording
+    void record(Camera &camera, uint32_t inputFlags);
+    bool save(const char *path) const;
+
+    // Loading, fails rather than leave an empty path
+    bool load(const char *path);
+    bool loadKeyframes(const char *path);
+    bool buildFromKeyframes(const std::vector<CameraKeyframe> &keyframes);
+
+    // Replay
+    void apply(size_t frame, Camera &camera) const;
+    size_t size() const;
+};
+#endif
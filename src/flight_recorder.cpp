@@ -0,0 +1,118 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include "flight_recorder.h"
+#include "gl_instrumentation.h"
+
+FlightRecorder flightRecorder;
+
+void FlightRecorder::beginFrame()
+{
+    isFrameActive = isEnabled;
+    if (!isFrameActive)
+        return;
+
+    FlightRecorderFrame &frame = frames[frameNumber % FLIGHT_RECORDER_FRAMES];
+    frame.frameNumber = frameNumber;
+    frame.start = Tracer::now();
+    frame.scopeCount = 0;
+}
+
+void FlightRecorder::addScope(const char *name, uint64_t start, uint64_t end)
+{
+    if (!isFrameActive)
+        return;
+
+    FlightRecorderFrame &frame = frames[frameNumber % FLIGHT_RECORDER_FRAMES];
+    if (frame.scopeCount == FLIGHT_RECORDER_SCOPES)
+        return;
+
+    TraceEvent &scope = frame.scopes[frame.scopeCount++];
+    scope.name = name;
+    scope.start = start;
+    scope.duration = end > start ? end - start : 0;
+}
+
+void FlightRecorder::endFrame(const RenderStats &stats)
+{
+    if (!isFrameActive)
+        return;
+    isFrameActive = false;
+
+    FlightRecorderFrame &frame = frames[frameNumber % FLIGHT_RECORDER_FRAMES];
+    frame.end = Tracer::now();
+    frame.stats = stats;
+
+    double frameTime = (frame.end - frame.start) / 1e6;
+    frameTimes[frameNumber % HITCH_MEDIAN_WINDOW] = frameTime;
+    frameNumber++;
+
+    // Wait for a full median window, and after a dump for the ring to refill
+    if (frameNumber < HITCH_MEDIAN_WINDOW || (hasDumped && frameNumber - lastDumpFrame < FLIGHT_RECORDER_FRAMES / 2))
+        return;
+
+    double median = rollingMedian();
+    if (frameTime <= hitchFactor * median)
+        return;
+
+    std::string path = dumpPrefix + "_" + std::to_string(frame.frameNumber) + ".json";
+    if (dump(path.c_str(), frame.frameNumber, frameTime, median))
+        std::cout << "Hitch: frame " << frame.frameNumber << " took " << frameTime << "ms (median " << median << "ms), trace written to " << path << std::endl;
+    hasDumped = true;
+    lastDumpFrame = frameNumber;
+}
+
+double FlightRecorder::rollingMedian() const
+{
+    double window[HITCH_MEDIAN_WINDOW];
+    std::copy(frameTimes, frameTimes + HITCH_MEDIAN_WINDOW, window);
+    std::nth_element(window, window + HITCH_MEDIAN_WINDOW / 2, window + HITCH_MEDIAN_WINDOW);
+    return window[HITCH_MEDIAN_WINDOW / 2];
+}
+
+// Chrome trace-event JSON of every retained frame with counters and a marker on the hitch
+bool FlightRecorder::dump(const char *path, uint64_t hitchFrame, double frameTime, double median) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::FLIGHT_RECORDER::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    uint64_t count = std::min<uint64_t>(frameNumber, FLIGHT_RECORDER_FRAMES);
+    uint64_t first = frameNumber - count;
+    uint64_t origin = frames[first % FLIGHT_RECORDER_FRAMES].start;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Render\"}}";
+    for (uint64_t i = first; i < frameNumber; i++)
+    {
+        const FlightRecorderFrame &frame = frames[i % FLIGHT_RECORDER_FRAMES];
+        bool isHitch = frame.frameNumber == hitchFrame;
+        double ts = (frame.start - origin) / 1000.0;
+
+        file << ",\n{\"name\":\"frame " << frame.frameNumber << (isHitch ? " (hitch)" : "")
+             << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts
+             << ",\"dur\":" << (frame.end - frame.start) / 1000.0 << '}';
+        for (unsigned int s = 0; s < frame.scopeCount; s++)
+            file << ",\n{\"name\":\"" << frame.scopes[s].name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                 << (frame.scopes[s].start - origin) / 1000.0 << ",\"dur\":" << frame.scopes[s].duration / 1000.0 << '}';
+
+        // The counters only mean something in a GL_INSTRUMENTATION build
+        if (isGLInstrumentationInstalled())
+            file << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts << ",\"args\":{"
+                 << "\"draw_calls\":" << frame.stats.drawCalls << ",\"program_binds\":" << frame.stats.programBinds
+                 << ",\"texture_binds\":" << frame.stats.textureBinds << ",\"vertex_array_binds\":" << frame.stats.vertexArrayBinds
+                 << ",\"uniform_calls\":" << frame.stats.uniformCalls << ",\"buffer_upload_bytes\":" << frame.stats.bufferUploadBytes
+                 << ",\"texture_upload_bytes\":" << frame.stats.textureUploadBytes << "}}";
+
+        if (isHitch)
+            file << ",\n{\"name\":\"hitch\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":" << ts
+                 << ",\"args\":{\"frame_ms\":" << frameTime << ",\"median_ms\":" << median << ",\"factor\":" << hitchFactor << "}}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <cstdint>
+#include <string>
+#include "render_stats.h"
+#include "trace.h"
+
+// About 8 seconds at 60 fps
+const unsigned int FLIGHT_RECORDER_FRAMES = 512;
+const unsigned int FLIGHT_RECORDER_SCOPES = 16;
+const unsigned int HITCH_MEDIAN_WINDOW = 120;
+
+struct FlightRecorderFrame
+{
+    uint64_t frameNumber = 0;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    RenderStats stats;
+    TraceEvent scopes[FLIGHT_RECORDER_SCOPES];
+    unsigned int scopeCount = 0;
+};
+
+// Always-on ring of recent frames, dumped as a Chrome trace when a frame takes
+// longer than hitchFactor times the rolling median
+class FlightRecorder
+{
+    public:
+
+    bool isEnabled = true;
+    float hitchFactor = 3.f;
+    std::string dumpPrefix = "hitch";
+
+    // Methods
+    void beginFrame();
+    void addScope(const char *name, uint64_t start, uint64_t end);
+    void endFrame(const RenderStats &stats);
+    bool dump(const char *path, uint64_t hitchFrame, double frameTime, double median) const;
+
+    private:
+
+    FlightRecorderFrame frames[FLIGHT_RECORDER_FRAMES];
+    double frameTimes[HITCH_MEDIAN_WINDOW] = {};
+    uint64_t frameNumber = 0;
+    uint64_t lastDumpFrame = 0;
+    bool isFrameActive = false;
+    bool hasDumped = false;
+
+    double rollingMedian() const;
+};
+
+extern FlightRecorder flightRecorder;
+#endif
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include "gl_debug.h"
+
+static GLDebugSettings debugSettings;
+static bool isDebugEnabled = false;
+
+// Rate limiting state
+static std::mutex debugMutex;
+static std::unordered_map<GLuint, unsigned int> messageCounts;
+static std::chrono::steady_clock::time_point windowStart;
+static unsigned int windowMessages = 0;
+static unsigned int droppedMessages = 0;
+
+static int severityRank(GLenum severity)
+{
+    switch (severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH:
+            return 3;
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            return 2;
+        case GL_DEBUG_SEVERITY_LOW:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static const char *typeName(GLenum type)
+{
+    switch (type)
+    {
+        case GL_DEBUG_TYPE_ERROR:
+            return "ERROR";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+            return "DEPRECATED";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+            return "UNDEFINED";
+        case GL_DEBUG_TYPE_PORTABILITY:
+            return "PORTABILITY";
+        case GL_DEBUG_TYPE_PERFORMANCE:
+            return "PERFORMANCE";
+        case GL_DEBUG_TYPE_MARKER:
+            return "MARKER";
+        default:
+            return "OTHER";
+    }
+}
+
+static const char *severityName(GLenum severity)
+{
+    switch (severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH:
+            return "HIGH";
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            return "MEDIUM";
+        case GL_DEBUG_SEVERITY_LOW:
+            return "LOW";
+        default:
+            return "NOTIFICATION";
+    }
+}
+
+static void APIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam)
+{
+    // Own debug group markers echo back through the callback
+    if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP)
+        return;
+    if (debugSettings.isPerformanceOnly && type != GL_DEBUG_TYPE_PERFORMANCE)
+        return;
+    if (severityRank(severity) < severityRank(debugSettings.minSeverity))
+        return;
+
+    std::lock_guard<std::mutex> lock(debugMutex);
+
+    unsigned int &count = messageCounts[id];
+    if (++count > debugSettings.maxRepeats)
+    {
+        droppedMessages++;
+        return;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - windowStart > std::chrono::seconds(1))
+    {
+        windowStart = now;
+        windowMessages = 0;
+    }
+    if (++windowMessages > debugSettings.maxMessagesPerSecond)
+    {
+        droppedMessages++;
+        return;
+    }
+
+    std::cout << "GL::" << typeName(type) << "::" << severityName(severity) << " [" << id << "]: " << message
+              << (count == debugSettings.maxRepeats ? " (further repeats suppressed)" : "") << std::endl;
+}
+
+// Requires a current GL context
+bool hasGLExtension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const GLubyte *extension = glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(reinterpret_cast<const char*>(extension), name) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool initGLDebug(GLADloadproc loader, const GLDebugSettings &settings)
+{
+    debugSettings = settings;
+    if (!settings.isEnabled)
+        return false;
+
+    // glad only loads 4.3 entry points for 4.3+ contexts, KHR_debug exposes them on 3.3 too
+    if (!glad_glDebugMessageCallback && hasGLExtension("GL_KHR_debug"))
+    {
+        glad_glDebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)loader("glDebugMessageCallback");
+        glad_glDebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC)loader("glDebugMessageControl");
+        glad_glObjectLabel = (PFNGLOBJECTLABELPROC)loader("glObjectLabel");
+        glad_glPushDebugGroup = (PFNGLPUSHDEBUGGROUPPROC)loader("glPushDebugGroup");
+        glad_glPopDebugGroup = (PFNGLPOPDEBUGGROUPPROC)loader("glPopDebugGroup");
+    }
+    if (!glad_glDebugMessageCallback)
+    {
+        std::cout << "ERROR::GL_DEBUG::KHR_DEBUG_NOT_SUPPORTED" << std::endl;
+        return false;
+    }
+
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT))
+        std::cout << "WARNING::GL_DEBUG::NOT_A_DEBUG_CONTEXT, driver may report fewer messages" << std::endl;
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(debugCallback, NULL);
+
+    // Drop notifications in the driver rather than in the callback
+    if (severityRank(settings.minSeverity) > 0)
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
+
+    windowStart = std::chrono::steady_clock::now();
+    isDebugEnabled = true;
+    return true;
+}
+
+bool isGLDebugEnabled()
+{
+    return isDebugEnabled;
+}
+
+void printGLDebugSummary()
+{
+    std::lock_guard<std::mutex> lock(debugMutex);
+    if (droppedMessages)
+        std::cout << "GL debug: " << droppedMessages << " repeated or rate-limited messages suppressed" << std::endl;
+}
+
+void labelObject(GLenum identifier, GLuint name, const std::string &label)
+{
+    if (isDebugEnabled && glad_glObjectLabel)
+        glObjectLabel(identifier, name, static_cast<GLsizei>(label.size()), label.c_str());
+}
+
+void pushDebugGroup(const char *name)
+{
+    if (isDebugEnabled && glad_glPushDebugGroup)
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+void popDebugGroup()
+{
+    if (isDebugEnabled && glad_glPopDebugGroup)
+        glPopDebugGroup();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef GL_DEBUG_H
+#define GL_DEBUG_H
+
+#include <string>
+#include "glad/glad.h"
+
+struct GLDebugSettings
+{
+    bool isEnabled = false;
+    bool isPerformanceOnly = false;
+    GLenum minSeverity = GL_DEBUG_SEVERITY_LOW;
+    unsigned int maxRepeats = 5;             // Per message id, further repeats are only counted
+    unsigned int maxMessagesPerSecond = 50;
+};
+
+// Registers the KHR_debug callback, requires a debug context and a current GL context
+bool initGLDebug(GLADloadproc loader, const GLDebugSettings &settings);
+bool isGLDebugEnabled();
+void printGLDebugSummary();
+bool hasGLExtension(const char *name);
+
+// No-ops unless debug output is enabled
+void labelObject(GLenum identifier, GLuint name, const std::string &label);
+void pushDebugGroup(const char *name);
+void popDebugGroup();
+#endif
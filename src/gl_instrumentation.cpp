@@ -0,0 +1,336 @@
+#include "glad/glad.h"
+#include "gl_instrumentation.h"
+#include "render_stats.h"
+
+RenderStats renderStats;
+
+static bool isInstalled = false;
+
+#ifdef GL_INSTRUMENTATION
+
+// Original entry points
+static PFNGLDRAWARRAYSPROC realDrawArrays;
+static PFNGLDRAWELEMENTSPROC realDrawElements;
+static PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced;
+static PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced;
+static PFNGLMULTIDRAWARRAYSPROC realMultiDrawArrays;
+static PFNGLMULTIDRAWELEMENTSPROC realMultiDrawElements;
+static PFNGLMULTIDRAWARRAYSINDIRECTPROC realMultiDrawArraysIndirect;
+static PFNGLUSEPROGRAMPROC realUseProgram;
+static PFNGLBINDTEXTUREPROC realBindTexture;
+static PFNGLBINDVERTEXARRAYPROC realBindVertexArray;
+static PFNGLBUFFERDATAPROC realBufferData;
+static PFNGLBUFFERSUBDATAPROC realBufferSubData;
+static PFNGLBUFFERSTORAGEPROC realBufferStorage;
+static PFNGLMAPBUFFERRANGEPROC realMapBufferRange;
+static PFNGLTEXIMAGE2DPROC realTexImage2D;
+static PFNGLTEXSUBIMAGE2DPROC realTexSubImage2D;
+static PFNGLTEXSUBIMAGE3DPROC realTexSubImage3D;
+static PFNGLCOMPRESSEDTEXIMAGE2DPROC realCompressedTexImage2D;
+static PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC realCompressedTexSubImage2D;
+static PFNGLUNIFORM1IPROC realUniform1i;
+static PFNGLUNIFORM1FPROC realUniform1f;
+static PFNGLUNIFORM2FPROC realUniform2f;
+static PFNGLUNIFORM3FPROC realUniform3f;
+static PFNGLUNIFORM4FPROC realUniform4f;
+static PFNGLUNIFORM1IVPROC realUniform1iv;
+static PFNGLUNIFORM1FVPROC realUniform1fv;
+static PFNGLUNIFORM3FVPROC realUniform3fv;
+static PFNGLUNIFORM4FVPROC realUniform4fv;
+static PFNGLUNIFORMMATRIX3FVPROC realUniformMatrix3fv;
+static PFNGLUNIFORMMATRIX4FVPROC realUniformMatrix4fv;
+
+// Bytes of one pixel for uncompressed uploads
+static unsigned long long pixelSize(GLenum format, GLenum type)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_24_8:
+            return 4;
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+    }
+
+    unsigned long long components = 4;
+    switch (format)
+    {
+        case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+            components = 1;
+            break;
+        case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+            components = 2;
+            break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+            components = 3;
+            break;
+    }
+
+    switch (type)
+    {
+        case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT:
+            return components * 4;
+        default:
+            return components;
+    }
+}
+
+// Draws
+static void APIENTRY countedDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    renderStats.drawCalls++;
+    realDrawArrays(mode, first, count);
+}
+
+static void APIENTRY countedDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    renderStats.drawCalls++;
+    realDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY countedDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+    renderStats.drawCalls++;
+    realDrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+static void APIENTRY countedDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instanceCount)
+{
+    renderStats.drawCalls++;
+    realDrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+static void APIENTRY countedMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawCount)
+{
+    renderStats.drawCalls++;
+    realMultiDrawArrays(mode, first, count, drawCount);
+}
+
+static void APIENTRY countedMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei drawCount)
+{
+    renderStats.drawCalls++;
+    realMultiDrawElements(mode, count, type, indices, drawCount);
+}
+
+static void APIENTRY countedMultiDrawArraysIndirect(GLenum mode, const void *indirect, GLsizei drawCount, GLsizei stride)
+{
+    renderStats.drawCalls++;
+    realMultiDrawArraysIndirect(mode, indirect, drawCount, stride);
+}
+
+// Binds
+static void APIENTRY countedUseProgram(GLuint program)
+{
+    renderStats.programBinds++;
+    realUseProgram(program);
+}
+
+static void APIENTRY countedBindTexture(GLenum target, GLuint texture)
+{
+    renderStats.textureBinds++;
+    realBindTexture(target, texture);
+}
+
+static void APIENTRY countedBindVertexArray(GLuint array)
+{
+    renderStats.vertexArrayBinds++;
+    realBindVertexArray(array);
+}
+
+// Buffer uploads
+static void APIENTRY countedBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    renderStats.bufferUploads++;
+    renderStats.bufferUploadBytes += data ? size : 0;
+    realBufferData(target, size, data, usage);
+}
+
+static void APIENTRY countedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    renderStats.bufferUploads++;
+    renderStats.bufferUploadBytes += size;
+    realBufferSubData(target, offset, size, data);
+}
+
+static void APIENTRY countedBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+    renderStats.bufferUploads++;
+    renderStats.bufferUploadBytes += data ? size : 0;
+    realBufferStorage(target, size, data, flags);
+}
+
+static void *APIENTRY countedMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    if (access & GL_MAP_WRITE_BIT)
+    {
+        renderStats.bufferUploads++;
+        renderStats.bufferUploadBytes += length;
+    }
+    return realMapBufferRange(target, offset, length, access);
+}
+
+// Texture uploads (sources in a bound pixel unpack buffer are counted too)
+static void APIENTRY countedTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
+{
+    renderStats.textureUploads++;
+    renderStats.textureUploadBytes += static_cast<unsigned long long>(width) * height * pixelSize(format, type);
+    realTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+static void APIENTRY countedTexSubImage2D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+{
+    renderStats.textureUploads++;
+    renderStats.textureUploadBytes += static_cast<unsigned long long>(width) * height * pixelSize(format, type);
+    realTexSubImage2D(target, level, xOffset, yOffset, width, height, format, type, pixels);
+}
+
+static void APIENTRY countedTexSubImage3D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLint zOffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels)
+{
+    renderStats.textureUploads++;
+    renderStats.textureUploadBytes += static_cast<unsigned long long>(width) * height * depth * pixelSize(format, type);
+    realTexSubImage3D(target, level, xOffset, yOffset, zOffset, width, height, depth, format, type, pixels);
+}
+
+static void APIENTRY countedCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data)
+{
+    renderStats.textureUploads++;
+    renderStats.textureUploadBytes += imageSize;
+    realCompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, data);
+}
+
+static void APIENTRY countedCompressedTexSubImage2D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void *data)
+{
+    renderStats.textureUploads++;
+    renderStats.textureUploadBytes += imageSize;
+    realCompressedTexSubImage2D(target, level, xOffset, yOffset, width, height, format, imageSize, data);
+}
+
+// Uniforms
+static void APIENTRY countedUniform1i(GLint location, GLint v0)
+{
+    renderStats.uniformCalls++;
+    realUniform1i(location, v0);
+}
+
+static void APIENTRY countedUniform1f(GLint location, GLfloat v0)
+{
+    renderStats.uniformCalls++;
+    realUniform1f(location, v0);
+}
+
+static void APIENTRY countedUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    renderStats.uniformCalls++;
+    realUniform2f(location, v0, v1);
+}
+
+static void APIENTRY countedUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    renderStats.uniformCalls++;
+    realUniform3f(location, v0, v1, v2);
+}
+
+static void APIENTRY countedUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    renderStats.uniformCalls++;
+    realUniform4f(location, v0, v1, v2, v3);
+}
+
+static void APIENTRY countedUniform1iv(GLint location, GLsizei count, const GLint *value)
+{
+    renderStats.uniformCalls++;
+    realUniform1iv(location, count, value);
+}
+
+static void APIENTRY countedUniform1fv(GLint location, GLsizei count, const GLfloat *value)
+{
+    renderStats.uniformCalls++;
+    realUniform1fv(location, count, value);
+}
+
+static void APIENTRY countedUniform3fv(GLint location, GLsizei count, const GLfloat *value)
+{
+    renderStats.uniformCalls++;
+    realUniform3fv(location, count, value);
+}
+
+static void APIENTRY countedUniform4fv(GLint location, GLsizei count, const GLfloat *value)
+{
+    renderStats.uniformCalls++;
+    realUniform4fv(location, count, value);
+}
+
+static void APIENTRY countedUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    renderStats.uniformCalls++;
+    realUniformMatrix3fv(location, count, transpose, value);
+}
+
+static void APIENTRY countedUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    renderStats.uniformCalls++;
+    realUniformMatrix4fv(location, count, transpose, value);
+}
+
+// Swap a loaded entry point for its wrapper, entry points the driver lacks stay NULL
+template <typename Function>
+static void hook(Function &entry, Function &original, Function wrapper)
+{
+    original = entry;
+    if (entry)
+        entry = wrapper;
+}
+
+#endif
+
+void installGLInstrumentation()
+{
+#ifdef GL_INSTRUMENTATION
+    if (isInstalled)
+        return;
+
+    hook(glad_glDrawArrays, realDrawArrays, countedDrawArrays);
+    hook(glad_glDrawElements, realDrawElements, countedDrawElements);
+    hook(glad_glDrawArraysInstanced, realDrawArraysInstanced, countedDrawArraysInstanced);
+    hook(glad_glDrawElementsInstanced, realDrawElementsInstanced, countedDrawElementsInstanced);
+    hook(glad_glMultiDrawArrays, realMultiDrawArrays, countedMultiDrawArrays);
+    hook(glad_glMultiDrawElements, realMultiDrawElements, countedMultiDrawElements);
+    hook(glad_glMultiDrawArraysIndirect, realMultiDrawArraysIndirect, countedMultiDrawArraysIndirect);
+    hook(glad_glUseProgram, realUseProgram, countedUseProgram);
+    hook(glad_glBindTexture, realBindTexture, countedBindTexture);
+    hook(glad_glBindVertexArray, realBindVertexArray, countedBindVertexArray);
+    hook(glad_glBufferData, realBufferData, countedBufferData);
+    hook(glad_glBufferSubData, realBufferSubData, countedBufferSubData);
+    hook(glad_glBufferStorage, realBufferStorage, countedBufferStorage);
+    hook(glad_glMapBufferRange, realMapBufferRange, countedMapBufferRange);
+    hook(glad_glTexImage2D, realTexImage2D, countedTexImage2D);
+    hook(glad_glTexSubImage2D, realTexSubImage2D, countedTexSubImage2D);
+    hook(glad_glTexSubImage3D, realTexSubImage3D, countedTexSubImage3D);
+    hook(glad_glCompressedTexImage2D, realCompressedTexImage2D, countedCompressedTexImage2D);
+    hook(glad_glCompressedTexSubImage2D, realCompressedTexSubImage2D, countedCompressedTexSubImage2D);
+    hook(glad_glUniform1i, realUniform1i, countedUniform1i);
+    hook(glad_glUniform1f, realUniform1f, countedUniform1f);
+    hook(glad_glUniform2f, realUniform2f, countedUniform2f);
+    hook(glad_glUniform3f, realUniform3f, countedUniform3f);
+    hook(glad_glUniform4f, realUniform4f, countedUniform4f);
+    hook(glad_glUniform1iv, realUniform1iv, countedUniform1iv);
+    hook(glad_glUniform1fv, realUniform1fv, countedUniform1fv);
+    hook(glad_glUniform3fv, realUniform3fv, countedUniform3fv);
+    hook(glad_glUniform4fv, realUniform4fv, countedUniform4fv);
+    hook(glad_glUniformMatrix3fv, realUniformMatrix3fv, countedUniformMatrix3fv);
+    hook(glad_glUniformMatrix4fv, realUniformMatrix4fv, countedUniformMatrix4fv);
+    isInstalled = true;
+#endif
+}
+
+bool isGLInstrumentationInstalled()
+{
+    return isInstalled;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#ifndef GL_INSTRUMENTATION_H
+#define GL_INSTRUMENTATION_H
+
+// Replace glad's entry points with wrappers that feed renderStats.
+// Call once after gladLoadGLLoader, does nothing unless built with GL_INSTRUMENTATION.
+void installGLInstrumentation();
+bool isGLInstrumentationInstalled();
+#endif
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include "headless.h"
+
+#ifdef HAS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+bool HeadlessContext::init(int width, int height, bool isDebugContext)
+{
+    this->width = width;
+    this->height = height;
+
+#ifdef HAS_EGL
+    // Surfaceless platform needs no display server or window system
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay eglDisplay = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL) : EGL_NO_DISPLAY;
+    if (eglDisplay == EGL_NO_DISPLAY)
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+    {
+        std::cout << "ERROR::HEADLESS::FAILED_TO_INITIALIZE_EGL" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount);
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_DEBUG, isDebugContext ? EGL_TRUE : EGL_FALSE,
+        EGL_NONE
+    };
+    eglBindAPI(EGL_OPENGL_API);
+    EGLContext eglContext = eglCreateContext(eglDisplay, configCount > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+    {
+        std::cout << "ERROR::HEADLESS::FAILED_TO_CREATE_CONTEXT: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        eglTerminate(eglDisplay);
+        return false;
+    }
+
+    display = eglDisplay;
+    context = eglContext;
+    return true;
+#else
+    std::cout << "ERROR::HEADLESS::BUILT_WITHOUT_EGL" << std::endl;
+    return false;
+#endif
+}
+
+// Requires GL functions to be loaded
+bool HeadlessContext::initFramebuffer()
+{
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (framebuffer)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        framebuffer = 0;
+    }
+
+#ifdef HAS_EGL
+    if (display)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        display = nullptr;
+        context = nullptr;
+    }
+#endif
+}
+
+void *HeadlessContext::getProcAddress(const char *name)
+{
+#ifdef HAS_EGL
+    return (void*)eglGetProcAddress(name);
+#else
+    return nullptr;
+#endif
+}
+
+bool writeFramebufferPPM(const char *path, int width, int height)
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::Failed to write screenshot to: " << path << std::endl;
+        return false;
+    }
+
+    // GL rows start at the bottom
+    file << "P6\n" << width << ' ' << height << "\n255\n";
+    for (int row = height - 1; row >= 0; row--)
+        file.write(reinterpret_cast<const char*>(&pixels[static_cast<size_t>(row) * width * 3]), width * 3);
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "glad/glad.h"
+
+// Display-less GL context (EGL surfaceless) rendering into an offscreen framebuffer
+class HeadlessContext
+{
+    public:
+
+    int width = 0;
+    int height = 0;
+    unsigned int framebuffer = 0;
+
+    // Methods
+    bool init(int width, int height, bool isDebugContext = false);
+    bool initFramebuffer();
+    void destroy();
+    static void *getProcAddress(const char *name);
+
+    private:
+
+    void *display = nullptr;
+    void *context = nullptr;
+    unsigned int colorBuffer = 0;
+    unsigned int depthBuffer = 0;
+};
+
+// Read back the currently bound framebuffer into a binary PPM
+bool writeFramebufferPPM(const char *path, int width, int height);
+#endif
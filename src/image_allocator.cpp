@@ -0,0 +1,331 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "image_allocator.h"
+#include "stb_image.h"
+
+enum ImageBlockKind : uint32_t
+{
+    IMAGE_BLOCK_HEAP,
+    IMAGE_BLOCK_ARENA,
+    IMAGE_BLOCK_POOL,
+    IMAGE_BLOCK_TARGET
+};
+
+// Precedes every block handed to stb_image, keeps the 16 byte alignment malloc gives
+struct alignas(16) ImageBlockHeader
+{
+    uint32_t kind;
+    uint32_t sizeClass;
+    size_t size;
+};
+static_assert(sizeof(ImageBlockHeader) == IMAGE_BLOCK_HEADER_BYTES, "decodeImageInto regions reserve one header");
+
+// Bump allocator over fixed chunks, individual frees are no-ops and the whole arena is reset after each decode
+struct ImageArena
+{
+    std::vector<unsigned char*> chunks;
+    size_t chunkIndex = 0;
+    size_t offset = 0;
+
+    ~ImageArena()
+    {
+        for (unsigned char *chunk : chunks)
+            std::free(chunk);
+    }
+
+    void *allocate(size_t bytes)
+    {
+        bytes = (bytes + 15) & ~static_cast<size_t>(15);
+        if (chunks.empty() || offset + bytes > IMAGE_ARENA_CHUNK_BYTES)
+        {
+            if (!chunks.empty())
+                chunkIndex++;
+            if (chunkIndex == chunks.size())
+            {
+                unsigned char *chunk = static_cast<unsigned char*>(std::malloc(IMAGE_ARENA_CHUNK_BYTES));
+                if (!chunk)
+                    return nullptr;
+                chunks.push_back(chunk);
+            }
+            offset = 0;
+        }
+        void *block = chunks[chunkIndex] + offset;
+        offset += bytes;
+        return block;
+    }
+
+    void reset()
+    {
+        chunkIndex = 0;
+        offset = 0;
+    }
+};
+
+struct ImageThreadState
+{
+    ImageArena arena;
+    bool isDecoding = false;
+    ImageDecodeStats stats;
+    size_t liveBytes = 0;
+
+    // Caller region for decodeImageInto, handed out to the first allocation of exactly the output size
+    ImageBlockHeader *target = nullptr;
+    size_t targetSize = 0;
+    bool isTargetInUse = false;
+};
+
+static thread_local ImageThreadState threadState;
+
+// Size classes IMAGE_ARENA_MAX_BLOCK << c, only blocks above the arena limit are pooled so the lock is rare
+static const unsigned int POOL_CLASS_COUNT = 11;
+
+struct ImagePool
+{
+    std::mutex mutex;
+    std::vector<void*> blocks[POOL_CLASS_COUNT];
+    size_t retainedBytes = 0;
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+
+    ~ImagePool()
+    {
+        for (std::vector<void*> &sizeClass : blocks)
+            for (void *block : sizeClass)
+                std::free(block);
+    }
+};
+
+static ImagePool pool;
+static std::atomic<unsigned long long> heapBlocks(0);
+
+static size_t poolClassBytes(unsigned int sizeClass)
+{
+    return IMAGE_ARENA_MAX_BLOCK << sizeClass;
+}
+
+static ImageBlockHeader *headerOf(void *block)
+{
+    return static_cast<ImageBlockHeader*>(block) - 1;
+}
+
+static void *allocateBlock(size_t size, bool isScratch)
+{
+    size_t bytes = size + sizeof(ImageBlockHeader);
+    ImageBlockHeader *header = nullptr;
+    ImageThreadState &state = threadState;
+    if (isScratch && state.target && !state.isTargetInUse && size == state.targetSize)
+    {
+        header = state.target;
+        header->kind = IMAGE_BLOCK_TARGET;
+        state.isTargetInUse = true;
+    }
+    else if (isScratch && size <= IMAGE_ARENA_MAX_BLOCK)
+    {
+        header = static_cast<ImageBlockHeader*>(state.arena.allocate(bytes));
+        if (header)
+            header->kind = IMAGE_BLOCK_ARENA;
+    }
+    else if (size > IMAGE_ARENA_MAX_BLOCK && bytes <= IMAGE_POOL_MAX_BLOCK)
+    {
+        unsigned int sizeClass = 0;
+        while (poolClassBytes(sizeClass) < bytes)
+            sizeClass++;
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (!pool.blocks[sizeClass].empty())
+            {
+                header = static_cast<ImageBlockHeader*>(pool.blocks[sizeClass].back());
+                pool.blocks[sizeClass].pop_back();
+                pool.retainedBytes -= poolClassBytes(sizeClass);
+                pool.hits++;
+            }
+            else
+                pool.misses++;
+        }
+        if (!header)
+            header = static_cast<ImageBlockHeader*>(std::malloc(poolClassBytes(sizeClass)));
+        if (header)
+        {
+            header->kind = IMAGE_BLOCK_POOL;
+            header->sizeClass = sizeClass;
+        }
+    }
+    else
+    {
+        header = static_cast<ImageBlockHeader*>(std::malloc(bytes));
+        if (header)
+            header->kind = IMAGE_BLOCK_HEAP;
+        heapBlocks++;
+    }
+
+    if (!header)
+        return nullptr;
+    header->size = size;
+    return header + 1;
+}
+
+void *imageMalloc(size_t size)
+{
+    ImageThreadState &state = threadState;
+    void *block = allocateBlock(size, state.isDecoding);
+    if (block && state.isDecoding)
+    {
+        // The caller's region is not engine memory, so it stays out of the peak
+        state.stats.allocations++;
+        if (headerOf(block)->kind != IMAGE_BLOCK_TARGET)
+            state.liveBytes += size;
+        state.stats.peakBytes = std::max(state.stats.peakBytes, state.liveBytes);
+    }
+    return block;
+}
+
+// Pooled blocks grow in place while their size class has room
+void *imageRealloc(void *block, size_t size)
+{
+    if (!block)
+        return imageMalloc(size);
+
+    ImageThreadState &state = threadState;
+    ImageBlockHeader *header = headerOf(block);
+    if (header->kind == IMAGE_BLOCK_POOL && size + sizeof(ImageBlockHeader) <= poolClassBytes(header->sizeClass))
+    {
+        if (state.isDecoding)
+        {
+            state.stats.allocations++;
+            state.liveBytes = state.liveBytes + size - header->size;
+            state.stats.peakBytes = std::max(state.stats.peakBytes, state.liveBytes);
+        }
+        header->size = size;
+        return block;
+    }
+
+    void *resized = imageMalloc(size);
+    if (!resized)
+        return nullptr;
+    std::memcpy(resized, block, std::min(size, header->size));
+    imageFree(block);
+    return resized;
+}
+
+// Any thread may free, arena blocks are reclaimed when their decode returns
+void imageFree(void *block)
+{
+    if (!block)
+        return;
+
+    ImageThreadState &state = threadState;
+    ImageBlockHeader *header = headerOf(block);
+    if (header->kind == IMAGE_BLOCK_TARGET)
+    {
+        state.isTargetInUse = false;
+        return;
+    }
+    if (state.isDecoding)
+        state.liveBytes -= std::min(state.liveBytes, header->size);
+    if (header->kind == IMAGE_BLOCK_ARENA)
+        return;
+    if (header->kind == IMAGE_BLOCK_POOL)
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        size_t classBytes = poolClassBytes(header->sizeClass);
+        if (pool.retainedBytes + classBytes <= IMAGE_POOL_RETAIN_BYTES)
+        {
+            pool.blocks[header->sizeClass].push_back(header);
+            pool.retainedBytes += classBytes;
+            return;
+        }
+    }
+    std::free(header);
+}
+
+static void beginDecode()
+{
+    threadState.isDecoding = true;
+    threadState.stats = ImageDecodeStats();
+    threadState.liveBytes = 0;
+}
+
+// Small results still sit in the arena, they are copied out before it is reset
+static unsigned char *endDecode(unsigned char *data, ImageDecodeStats *stats)
+{
+    ImageThreadState &state = threadState;
+    state.isDecoding = false;
+    if (data && headerOf(data)->kind == IMAGE_BLOCK_ARENA)
+    {
+        size_t size = headerOf(data)->size;
+        unsigned char *copy = static_cast<unsigned char*>(allocateBlock(size, false));
+        if (copy)
+            std::memcpy(copy, data, size);
+        data = copy;
+    }
+    state.arena.reset();
+    if (stats)
+        *stats = state.stats;
+    return data;
+}
+
+unsigned char *decodeImage(const unsigned char *bytes, size_t size, int *width, int *height, int *components,
+                           int desiredComponents, ImageDecodeStats *stats)
+{
+    beginDecode();
+    unsigned char *data = stbi_load_from_memory(bytes, static_cast<int>(size), width, height, components, desiredComponents);
+    return endDecode(data, stats);
+}
+
+unsigned char *decodeImageFile(const char *path, int *width, int *height, int *components, int desiredComponents,
+                               ImageDecodeStats *stats)
+{
+    beginDecode();
+    unsigned char *data = stbi_load(path, width, height, components, desiredComponents);
+    return endDecode(data, stats);
+}
+
+size_t imageDecodeBytes(const unsigned char *bytes, size_t size, int desiredComponents)
+{
+    int width, height, components;
+    if (!stbi_info_from_memory(bytes, static_cast<int>(size), &width, &height, &components))
+        return 0;
+    return static_cast<size_t>(width) * height * (desiredComponents ? desiredComponents : components);
+}
+
+unsigned char *decodeImageInto(const unsigned char *bytes, size_t size, unsigned char *region, size_t regionSize,
+                               int *width, int *height, int *components, int desiredComponents, ImageDecodeStats *stats)
+{
+    size_t pixelBytes = imageDecodeBytes(bytes, size, desiredComponents);
+    if (pixelBytes == 0 || regionSize < pixelBytes + IMAGE_BLOCK_HEADER_BYTES)
+        return nullptr;
+
+    ImageThreadState &state = threadState;
+    beginDecode();
+    state.target = reinterpret_cast<ImageBlockHeader*>(region);
+    state.targetSize = pixelBytes;
+    state.isTargetInUse = false;
+    unsigned char *data = stbi_load_from_memory(bytes, static_cast<int>(size), width, height, components, desiredComponents);
+    state.target = nullptr;
+
+    // The output went somewhere else, JPEG and 16-bit sources for example are converted into a second buffer
+    unsigned char *pixels = region + IMAGE_BLOCK_HEADER_BYTES;
+    if (data && data != pixels)
+    {
+        std::memcpy(pixels, data, pixelBytes);
+        state.stats.copiedBytes += pixelBytes;
+        imageFree(data);
+    }
+    endDecode(nullptr, stats);
+    return data ? pixels : nullptr;
+}
+
+void printImageAllocatorStats()
+{
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    std::cout << "Image allocator: " << pool.hits << " pool hits, " << pool.misses << " pool misses, "
+              << heapBlocks.load() << " heap blocks, " << std::fixed << std::setprecision(2)
+              << pool.retainedBytes / (1024.0 * 1024.0) << " MiB retained" << std::endl;
+}
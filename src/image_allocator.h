@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef IMAGE_ALLOCATOR_H
+#define IMAGE_ALLOCATOR_H
+
+#include <cstddef>
+
+// Blocks up to this size come from the decoding thread's arena, larger ones from the shared pool
+const size_t IMAGE_ARENA_MAX_BLOCK = 64 * 1024;
+const size_t IMAGE_ARENA_CHUNK_BYTES = 1024 * 1024;
+
+// Pool size classes are powers of two from the arena limit up to this, bigger images go straight to the heap
+const size_t IMAGE_POOL_MAX_BLOCK = 64 * 1024 * 1024;
+const size_t IMAGE_POOL_RETAIN_BYTES = 64 * 1024 * 1024;
+
+// Space decodeImageInto needs in front of the pixels it writes
+const size_t IMAGE_BLOCK_HEADER_BYTES = 16;
+
+// Allocations made by one decodeImage call
+struct ImageDecodeStats
+{
+    unsigned int allocations = 0;    // Including reallocations
+    size_t peakBytes = 0;            // Most bytes live at once, scratch and output
+    size_t copiedBytes = 0;          // Output copied into the caller's region because stb_image decoded elsewhere
+};
+
+// stb_image allocates through these, see stb_image.cpp. Scratch of a decodeImage call lives in a per-thread arena
+// that is reset when the call returns, large buffers and every returned image are recycled through a size-class pool.
+void *imageMalloc(size_t size);
+void *imageRealloc(void *block, size_t size);
+void imageFree(void *block);
+
+// Decodes like stbi_load_from_memory/stbi_load, the result is freed with stbi_image_free on any thread
+unsigned char *decodeImage(const unsigned char *bytes, size_t size, int *width, int *height, int *components,
+                           int desiredComponents, ImageDecodeStats *stats = nullptr);
+unsigned char *decodeImageFile(const char *path, int *width, int *height, int *components, int desiredComponents,
+                               ImageDecodeStats *stats = nullptr);
+
+// Bytes of the decoded pixels from the header alone, 0 if the image cannot be parsed
+size_t imageDecodeBytes(const unsigned char *bytes, size_t size, int desiredComponents);
+
+// Decodes into caller memory such as a mapped pixel buffer. The pixels land at region + IMAGE_BLOCK_HEADER_BYTES,
+// stb_image's output allocation is placed there so usually nothing is copied. Returns the pixels or nullptr on failure.
+unsigned char *decodeImageInto(const unsigned char *bytes, size_t size, unsigned char *region, size_t regionSize,
+                               int *width, int *height, int *components, int desiredComponents, ImageDecodeStats *stats = nullptr);
+void printImageAllocatorStats();
+#endif
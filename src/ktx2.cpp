@@ -0,0 +1,272 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include "glad/glad.h"
+#include "ktx2.h"
+
+const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+const size_t KTX2_HEADER_BYTES = 80;
+const size_t KTX2_LEVEL_INDEX_BYTES = 24;
+
+// Data format descriptor colour models and channels (Khronos Data Format Specification)
+const unsigned int KHR_DF_MODEL_BC1A = 128;
+const unsigned int KHR_DF_MODEL_BC3 = 130;
+const unsigned int KHR_DF_MODEL_BC4 = 131;
+const unsigned int KHR_DF_MODEL_BC5 = 132;
+const unsigned int KHR_DF_MODEL_BC7 = 134;
+const unsigned int KHR_DF_MODEL_ETC2 = 161;
+const unsigned int KHR_DF_SAMPLE_LINEAR = 1 << 4;
+
+struct DFDSample
+{
+    unsigned int bitOffset;
+    unsigned int bitLength;
+    unsigned int channel;
+};
+
+static void putU32(std::vector<unsigned char> &out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back((value >> (8 * i)) & 0xFF);
+}
+
+static void putU64(std::vector<unsigned char> &out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+        out.push_back((value >> (8 * i)) & 0xFF);
+}
+
+static uint32_t getU32(const unsigned char *in)
+{
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+static uint64_t getU64(const unsigned char *in)
+{
+    return getU32(in) | (static_cast<uint64_t>(getU32(in + 4)) << 32);
+}
+
+static bool isSRGB(unsigned int vkFormat)
+{
+    return vkFormat == VK_FORMAT_BC1_RGB_SRGB_BLOCK || vkFormat == VK_FORMAT_BC3_SRGB_BLOCK ||
+           vkFormat == VK_FORMAT_BC7_SRGB_BLOCK || vkFormat == VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK;
+}
+
+unsigned int ktx2BlockBytes(unsigned int vkFormat)
+{
+    switch (vkFormat)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            return 8;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+unsigned int ktx2InternalFormat(unsigned int vkFormat)
+{
+    switch (vkFormat)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case VK_FORMAT_BC3_UNORM_BLOCK: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case VK_FORMAT_BC3_SRGB_BLOCK: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case VK_FORMAT_BC4_UNORM_BLOCK: return GL_COMPRESSED_RED_RGTC1;
+        case VK_FORMAT_BC5_UNORM_BLOCK: return GL_COMPRESSED_RG_RGTC2;
+        case VK_FORMAT_BC7_UNORM_BLOCK: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case VK_FORMAT_BC7_SRGB_BLOCK: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK: return GL_COMPRESSED_RGB8_ETC2;
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK: return GL_COMPRESSED_SRGB8_ETC2;
+        default: return 0;
+    }
+}
+
+// Basic data format descriptor block for a 4x4 block-compressed format
+static std::vector<unsigned char> buildDFD(unsigned int vkFormat)
+{
+    unsigned int model;
+    std::vector<DFDSample> samples;
+    switch (vkFormat)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            model = KHR_DF_MODEL_BC1A;
+            samples = { { 0, 64, 0 } };
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            model = KHR_DF_MODEL_BC3;
+            samples = { { 0, 64, 15 }, { 64, 64, 0 } };
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            model = KHR_DF_MODEL_BC4;
+            samples = { { 0, 64, 0 } };
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            model = KHR_DF_MODEL_BC5;
+            samples = { { 0, 64, 0 }, { 64, 64, 1 } };
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            model = KHR_DF_MODEL_BC7;
+            samples = { { 0, 128, 0 } };
+            break;
+        default:
+            model = KHR_DF_MODEL_ETC2;
+            samples = { { 0, 64, 2 } };
+            break;
+    }
+
+    std::vector<unsigned char> dfd;
+    uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+    putU32(dfd, 4 + blockSize);                   // dfdTotalSize
+    putU32(dfd, 0);                               // vendorId, descriptorType
+    putU32(dfd, 2 | (blockSize << 16));           // versionNumber, descriptorBlockSize
+    dfd.push_back(model);
+    dfd.push_back(1);                             // BT.709 primaries
+    dfd.push_back(isSRGB(vkFormat) ? 2 : 1);      // sRGB or linear transfer
+    dfd.push_back(0);                             // Straight alpha
+    dfd.push_back(3);                             // 4x4 texel blocks
+    dfd.push_back(3);
+    dfd.push_back(0);
+    dfd.push_back(0);
+    dfd.push_back(ktx2BlockBytes(vkFormat));      // bytesPlane0..7
+    for (int i = 0; i < 7; i++)
+        dfd.push_back(0);
+    for (const DFDSample &sample : samples)
+    {
+        unsigned int qualifiers = (sample.channel == 15 && isSRGB(vkFormat)) ? KHR_DF_SAMPLE_LINEAR : 0;
+        dfd.push_back(sample.bitOffset & 0xFF);
+        dfd.push_back(sample.bitOffset >> 8);
+        dfd.push_back(sample.bitLength - 1);
+        dfd.push_back(sample.channel | qualifiers);
+        putU32(dfd, 0);                           // samplePosition
+        putU32(dfd, 0);                           // sampleLower
+        putU32(dfd, 0xFFFFFFFF);                  // sampleUpper
+    }
+    return dfd;
+}
+
+// Levels are passed largest first and stored smallest first, as the format requires
+bool writeKTX2(const char *path, unsigned int vkFormat, int width, int height, const std::vector<std::vector<unsigned char>> &levels)
+{
+    unsigned int blockBytes = ktx2BlockBytes(vkFormat);
+    if (blockBytes == 0 || levels.empty())
+    {
+        std::cout << "ERROR::KTX2::UNSUPPORTED_FORMAT: " << vkFormat << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> dfd = buildDFD(vkFormat);
+    size_t dfdOffset = KTX2_HEADER_BYTES + KTX2_LEVEL_INDEX_BYTES * levels.size();
+
+    // Level data is aligned to lcm(block size, 4), which is the block size for every supported format
+    std::vector<size_t> offsets(levels.size());
+    size_t offset = dfdOffset + dfd.size();
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        offset = (offset + blockBytes - 1) / blockBytes * blockBytes;
+        offsets[level] = offset;
+        offset += levels[level].size();
+    }
+
+    std::vector<unsigned char> file(KTX2_IDENTIFIER, KTX2_IDENTIFIER + 12);
+    putU32(file, vkFormat);
+    putU32(file, 1);                               // typeSize
+    putU32(file, width);
+    putU32(file, height);
+    putU32(file, 0);                               // pixelDepth
+    putU32(file, 0);                               // layerCount
+    putU32(file, 1);                               // faceCount
+    putU32(file, static_cast<uint32_t>(levels.size()));
+    putU32(file, 0);                               // No supercompression
+    putU32(file, static_cast<uint32_t>(dfdOffset));
+    putU32(file, static_cast<uint32_t>(dfd.size()));
+    putU32(file, 0);                               // No key/value data
+    putU32(file, 0);
+    putU64(file, 0);                               // No supercompression global data
+    putU64(file, 0);
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        putU64(file, offsets[level]);
+        putU64(file, levels[level].size());
+        putU64(file, levels[level].size());
+    }
+    file.insert(file.end(), dfd.begin(), dfd.end());
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        file.resize(offsets[level], 0);
+        file.insert(file.end(), levels[level].begin(), levels[level].end());
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(reinterpret_cast<const char*>(file.data()), file.size()))
+    {
+        std::cout << "ERROR::KTX2::FAILED_TO_WRITE: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readKTX2(const char *path, KTX2Image &image)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    image.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return parseKTX2(path, image);
+}
+
+// Fills in the header fields and level table from image.data, path is only used in error messages
+bool parseKTX2(const char *path, KTX2Image &image)
+{
+    const unsigned char *data = image.data.data();
+    if (image.data.size() < KTX2_HEADER_BYTES || std::memcmp(data, KTX2_IDENTIFIER, 12) != 0)
+    {
+        std::cout << "ERROR::KTX2::INVALID_FILE: " << path << std::endl;
+        return false;
+    }
+
+    image.vkFormat = getU32(data + 12);
+    image.width = static_cast<int>(getU32(data + 20));
+    image.height = static_cast<int>(getU32(data + 24));
+    uint32_t depth = getU32(data + 28), layers = getU32(data + 32), faces = getU32(data + 36);
+    uint32_t levelCount = std::max(getU32(data + 40), 1u);
+    uint32_t supercompression = getU32(data + 44);
+    if (ktx2InternalFormat(image.vkFormat) == 0 || depth != 0 || layers != 0 || faces != 1 || supercompression != 0 ||
+        image.width <= 0 || image.height <= 0 || image.data.size() < KTX2_HEADER_BYTES + KTX2_LEVEL_INDEX_BYTES * levelCount)
+    {
+        std::cout << "ERROR::KTX2::UNSUPPORTED_LAYOUT: " << path << std::endl;
+        return false;
+    }
+
+    image.levels.clear();
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        const unsigned char *entry = data + KTX2_HEADER_BYTES + KTX2_LEVEL_INDEX_BYTES * level;
+        KTX2Level info;
+        info.offset = getU64(entry);
+        info.size = getU64(entry + 8);
+        info.width = std::max(image.width >> level, 1);
+        info.height = std::max(image.height >> level, 1);
+        if (info.offset + info.size > image.data.size())
+        {
+            std::cout << "ERROR::KTX2::TRUNCATED_LEVEL: " << path << std::endl;
+            return false;
+        }
+        image.levels.push_back(info);
+    }
+    return true;
+}
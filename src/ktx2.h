@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef KTX2_H
+#define KTX2_H
+
+#include <cstddef>
+#include <vector>
+
+// S3TC is an extension and not part of the generated loader
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// Subset of VkFormat written by the texture cooker
+enum KTX2_Format
+{
+    VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131,
+    VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132,
+    VK_FORMAT_BC3_UNORM_BLOCK = 137,
+    VK_FORMAT_BC3_SRGB_BLOCK = 138,
+    VK_FORMAT_BC4_UNORM_BLOCK = 139,
+    VK_FORMAT_BC5_UNORM_BLOCK = 141,
+    VK_FORMAT_BC7_UNORM_BLOCK = 145,
+    VK_FORMAT_BC7_SRGB_BLOCK = 146,
+    VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147,
+    VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK = 148
+};
+
+struct KTX2Level
+{
+    size_t offset = 0;
+    size_t size = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Single-face 2D texture with a full set of compressed levels, level 0 first
+struct KTX2Image
+{
+    unsigned int vkFormat = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> data;
+    std::vector<KTX2Level> levels;
+};
+
+// Methods
+bool readKTX2(const char *path, KTX2Image &image);
+bool parseKTX2(const char *path, KTX2Image &image);
+bool writeKTX2(const char *path, unsigned int vkFormat, int width, int height, const std::vector<std::vector<unsigned char>> &levels);
+unsigned int ktx2BlockBytes(unsigned int vkFormat);
+unsigned int ktx2InternalFormat(unsigned int vkFormat);
+#endif
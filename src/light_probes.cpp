@@ -0,0 +1,140 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "light_probes.h"
+#include "lightmap.h"
+#include "scene.h"
+#include "gl_debug.h"
+
+const char LIGHT_PROBE_MAGIC[8] = { 'L', 'O', 'G', 'L', 'P', 'R', 'B', 'E' };
+
+// Half the diagonal of a unit cube, bounds every rotation of a cube around its centre
+const float CUBE_BOUNDING_RADIUS = .8660254f;
+
+// Bounds come from the cube positions rather than their matrices, the renderer reads them back from the file anyway
+ProbeGridLayout probeGridLayout(unsigned int instanceCount, float spacing)
+{
+    glm::vec3 boundsMin(0.f), boundsMax(0.f);
+    for (unsigned int i = 0; i < instanceCount; i++)
+    {
+        glm::vec3 center = CUBE_POSITIONS[i % CUBE_COUNT] + glm::vec3(0.f, 0.f, -CUBE_LAYER_SPACING * (i / CUBE_COUNT));
+        boundsMin = i == 0 ? center : glm::min(boundsMin, center);
+        boundsMax = i == 0 ? center : glm::max(boundsMax, center);
+    }
+    glm::vec3 padding(CUBE_BOUNDING_RADIUS + LIGHT_PROBE_MARGIN);
+    boundsMin -= padding;
+    boundsMax += padding;
+
+    glm::vec3 extent = boundsMax - boundsMin;
+    ProbeGridLayout layout;
+    layout.min = boundsMin;
+    layout.spacing = std::max(spacing, std::max(extent.x, std::max(extent.y, extent.z)) / (LIGHT_PROBE_MAX_COUNT - 1));
+    unsigned int *counts[3] = { &layout.countX, &layout.countY, &layout.countZ };
+    for (unsigned int axis = 0; axis < 3; axis++)
+    {
+        unsigned int count = static_cast<unsigned int>(std::ceil(extent[axis] / layout.spacing - 1e-4f)) + 1;
+        *counts[axis] = std::min(std::max(count, 2u), LIGHT_PROBE_MAX_COUNT);
+    }
+    return layout;
+}
+
+size_t probeCount(const ProbeGridLayout &layout)
+{
+    return static_cast<size_t>(layout.countX) * layout.countY * layout.countZ;
+}
+
+glm::vec3 probePosition(const ProbeGridLayout &layout, unsigned int x, unsigned int y, unsigned int z)
+{
+    return layout.min + glm::vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * layout.spacing;
+}
+
+bool writeLightProbes(const char *path, const ProbeGridLayout &layout, unsigned int instanceCount, unsigned int pointLightCount,
+                      const std::vector<uint16_t> &texels)
+{
+    if (texels.size() != probeCount(layout) * LIGHT_PROBE_SLOTS * 4)
+    {
+        std::cout << "ERROR::LIGHT_PROBES::SIZE_MISMATCH: " << path << std::endl;
+        return false;
+    }
+    LightProbeHeader header;
+    std::memcpy(header.magic, LIGHT_PROBE_MAGIC, sizeof(LIGHT_PROBE_MAGIC));
+    header.version = LIGHT_PROBE_VERSION;
+    header.countX = layout.countX;
+    header.countY = layout.countY;
+    header.countZ = layout.countZ;
+    header.instanceCount = instanceCount;
+    header.pointLightCount = pointLightCount;
+    header.spacing = layout.spacing;
+    header.min[0] = layout.min.x;
+    header.min[1] = layout.min.y;
+    header.min[2] = layout.min.z;
+    header.sceneHash = hashStaticLighting(instanceCount, pointLightCount);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+        !out.write(reinterpret_cast<const char*>(texels.data()), texels.size() * sizeof(uint16_t)))
+    {
+        std::cout << "ERROR::LIGHT_PROBES::FAILED_TO_WRITE: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Uploads the grid, false when the file is missing or was baked for another scene so the caller keeps the ambient terms
+bool LightProbes::load(const char *path, unsigned int instanceCount, unsigned int pointLightCount)
+{
+    std::ifstream file(path, std::ios::binary);
+    LightProbeHeader header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, LIGHT_PROBE_MAGIC, sizeof(LIGHT_PROBE_MAGIC)) != 0 || header.version != LIGHT_PROBE_VERSION)
+    {
+        std::cout << "ERROR::LIGHT_PROBES::FAILED_TO_READ: " << path << std::endl;
+        return false;
+    }
+    if (header.instanceCount != instanceCount || header.pointLightCount != pointLightCount ||
+        header.sceneHash != hashStaticLighting(instanceCount, pointLightCount))
+    {
+        std::cout << "ERROR::LIGHT_PROBES::STALE: " << path << " was baked for " << header.instanceCount << " objects and "
+                  << header.pointLightCount << " lights" << std::endl;
+        return false;
+    }
+    layout.min = glm::vec3(header.min[0], header.min[1], header.min[2]);
+    layout.spacing = header.spacing;
+    layout.countX = header.countX;
+    layout.countY = header.countY;
+    layout.countZ = header.countZ;
+
+    int maxSize = 0;
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxSize);
+    unsigned int depth = LIGHT_PROBE_SLOTS * layout.countZ;
+    bool isValidGrid = layout.countX >= 2 && layout.countY >= 2 && layout.countZ >= 2 && layout.spacing > 0.f &&
+                       layout.countX <= static_cast<unsigned int>(maxSize) && layout.countY <= static_cast<unsigned int>(maxSize) &&
+                       depth <= static_cast<unsigned int>(maxSize);
+    std::vector<uint16_t> texels(isValidGrid ? probeCount(layout) * LIGHT_PROBE_SLOTS * 4 : 0);
+    if (!isValidGrid || !file.read(reinterpret_cast<char*>(texels.data()), texels.size() * sizeof(uint16_t)))
+    {
+        std::cout << "ERROR::LIGHT_PROBES::INVALID_GRID: " << path << std::endl;
+        return false;
+    }
+
+    // Filtering across probes is the interpolation, the shader keeps z inside each slot so slots never blend
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_3D, texture);
+    labelObject(GL_TEXTURE, texture, "light probes");
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, layout.countX, layout.countY, depth, 0, GL_RGBA, GL_HALF_FLOAT, texels.data());
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    return true;
+}
+
+void LightProbes::destroy()
+{
+    glDeleteTextures(1, &texture);
+    texture = 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef LIGHT_PROBES_H
+#define LIGHT_PROBES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+
+// Written into the build directory by the bake_light_probes target, see tools/probe_bake.cpp
+const char* const LIGHT_PROBE_FILE_NAME = "light_probes.bin";
+const uint32_t LIGHT_PROBE_VERSION = 1;
+
+// L2 spherical harmonics, nine RGB coefficients padded into seven RGBA texels per probe
+const unsigned int SH_COEFFICIENT_COUNT = 9;
+const unsigned int LIGHT_PROBE_SLOTS = 7;
+
+// Distance between neighbouring probes and the space left around the cubes. Grids larger than
+// LIGHT_PROBE_MAX_COUNT probes along an axis are spread out instead, the slots stacked along z then still fit
+// the 256 texels every GL 3.3 driver allows for a 3D texture.
+const float LIGHT_PROBE_SPACING = 1.f;
+const float LIGHT_PROBE_MARGIN = 1.f;
+const unsigned int LIGHT_PROBE_MAX_COUNT = 36;
+
+// Texture unit the grid is bound to, after the lightmap
+const unsigned int LIGHT_PROBE_TEXTURE_UNIT = 4;
+
+// Axis-aligned grid of probes around every cube, probe (x, y, z) sits at min + (x, y, z) * spacing
+struct ProbeGridLayout
+{
+    glm::vec3 min = glm::vec3(0.f);
+    float spacing = 0.f;
+    unsigned int countX = 0;
+    unsigned int countY = 0;
+    unsigned int countZ = 0;
+};
+
+// File layout, native byte order: header, then LIGHT_PROBE_SLOTS * countZ * countY * countX RGBA16F texels, slot by
+// slot. Slot s of probe (x, y, z) is texel (x, y, s * countZ + z) of the 3D texture.
+struct LightProbeHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t countX;
+    uint32_t countY;
+    uint32_t countZ;
+    uint32_t instanceCount;
+    uint32_t pointLightCount;
+    float spacing;
+    float min[3];
+    uint64_t sceneHash;
+};
+
+// Grid shared by the baker and the renderer
+ProbeGridLayout probeGridLayout(unsigned int instanceCount, float spacing);
+size_t probeCount(const ProbeGridLayout &layout);
+glm::vec3 probePosition(const ProbeGridLayout &layout, unsigned int x, unsigned int y, unsigned int z);
+
+bool writeLightProbes(const char *path, const ProbeGridLayout &layout, unsigned int instanceCount, unsigned int pointLightCount,
+                      const std::vector<uint16_t> &texels);
+
+// Baked indirect lighting of the static lights, interpolated by cube_frag.glsl with PROBE_LIGHTING in place of the
+// per-light ambient terms
+class LightProbes
+{
+    public:
+
+    ProbeGridLayout layout;
+    unsigned int texture = 0;
+
+    // Methods
+    bool load(const char *path, unsigned int instanceCount, unsigned int pointLightCount);
+    void destroy();
+};
+#endif
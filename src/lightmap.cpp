@@ -0,0 +1,179 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "lightmap.h"
+#include "asset_pack.h"
+#include "gl_debug.h"
+
+const char LIGHTMAP_MAGIC[8] = { 'L', 'O', 'G', 'L', 'L', 'M', 'A', 'P' };
+
+// Blocks are 3:2, so about sqrt(2n/3) columns keep the atlas square
+LightmapLayout lightmapLayout(unsigned int instanceCount, unsigned int faceTexels)
+{
+    LightmapLayout layout;
+    unsigned int chartTexels = faceTexels + 2 * LIGHTMAP_GUTTER_TEXELS;
+    layout.faceTexels = faceTexels;
+    layout.instanceCount = instanceCount;
+    layout.blockWidth = 3 * chartTexels;
+    layout.blockHeight = 2 * chartTexels;
+    layout.columns = std::max(1u, std::min(instanceCount, static_cast<unsigned int>(std::ceil(std::sqrt(2.0 * instanceCount / 3.0)))));
+    unsigned int rows = (instanceCount + layout.columns - 1) / layout.columns;
+    layout.width = layout.columns * layout.blockWidth;
+    layout.height = rows * layout.blockHeight;
+    return layout;
+}
+
+// Maps the mesh lightmap UVs (0-1 over one block) onto the instance's block in the atlas
+glm::vec4 lightmapScaleOffset(const LightmapLayout &layout, unsigned int instance)
+{
+    float column = static_cast<float>(instance % layout.columns);
+    float row = static_cast<float>(instance / layout.columns);
+    glm::vec2 scale(static_cast<float>(layout.blockWidth) / layout.width, static_cast<float>(layout.blockHeight) / layout.height);
+    return glm::vec4(scale, column * scale.x, row * scale.y);
+}
+
+// Every face already spans 0-1 in its texture coordinates, so each becomes one chart of the 3x2 block, inset by the gutter
+void buildCubeLightmapUVs(unsigned int faceTexels, glm::vec2 uvs[CUBE_VERTEX_COUNT])
+{
+    float chartTexels = static_cast<float>(faceTexels + 2 * LIGHTMAP_GUTTER_TEXELS);
+    for (unsigned int vertex = 0; vertex < CUBE_VERTEX_COUNT; vertex++)
+    {
+        unsigned int face = vertex / 6;
+        glm::vec2 chart(static_cast<float>(face % 3), static_cast<float>(face / 3));
+        glm::vec2 faceUV(CUBE_VERTICES[vertex * CUBE_VERTEX_STRIDE + 6], CUBE_VERTICES[vertex * CUBE_VERTEX_STRIDE + 7]);
+        glm::vec2 texel = chart * chartTexels + glm::vec2(static_cast<float>(LIGHTMAP_GUTTER_TEXELS)) + faceUV * static_cast<float>(faceTexels);
+        uvs[vertex] = texel / glm::vec2(3.f * chartTexels, 2.f * chartTexels);
+    }
+}
+
+// Hashes the scene constants rather than the matrices built from them, those can differ in the last bit between the
+// baker and the renderer when they are compiled with different flags
+uint64_t hashStaticLighting(unsigned int instanceCount, unsigned int pointLightCount)
+{
+    std::vector<float> inputs = { static_cast<float>(instanceCount), CUBE_LAYER_SPACING };
+    for (unsigned int i = 0; i < CUBE_COUNT; i++)
+        inputs.insert(inputs.end(), &CUBE_POSITIONS[i].x, &CUBE_POSITIONS[i].x + 3);
+    for (unsigned int i = 0; i < pointLightCount; i++)
+    {
+        inputs.insert(inputs.end(), &POINT_LIGHT_POSITIONS[i].x, &POINT_LIGHT_POSITIONS[i].x + 3);
+        inputs.insert(inputs.end(), &POINT_LIGHT_COLORS[i].x, &POINT_LIGHT_COLORS[i].x + 3);
+    }
+    inputs.insert(inputs.end(), &DIR_LIGHT_DIRECTION.x, &DIR_LIGHT_DIRECTION.x + 3);
+    inputs.insert(inputs.end(), &DIR_LIGHT_DIFFUSE.x, &DIR_LIGHT_DIFFUSE.x + 3);
+    inputs.insert(inputs.end(), { LIGHT_CONSTANT, LIGHT_LINEAR, LIGHT_QUADRATIC, static_cast<float>(pointLightCount) });
+    return hashAssetBytes(reinterpret_cast<const unsigned char*>(inputs.data()), inputs.size() * sizeof(float));
+}
+
+bool writeLightmap(const char *path, const LightmapLayout &layout, unsigned int pointLightCount, const std::vector<uint16_t> &texels)
+{
+    if (texels.size() != static_cast<size_t>(layout.width) * layout.height * 4)
+    {
+        std::cout << "ERROR::LIGHTMAP::SIZE_MISMATCH: " << path << std::endl;
+        return false;
+    }
+    LightmapHeader header;
+    std::memcpy(header.magic, LIGHTMAP_MAGIC, sizeof(LIGHTMAP_MAGIC));
+    header.version = LIGHTMAP_VERSION;
+    header.faceTexels = layout.faceTexels;
+    header.instanceCount = layout.instanceCount;
+    header.width = layout.width;
+    header.height = layout.height;
+    header.pointLightCount = pointLightCount;
+    header.sceneHash = hashStaticLighting(layout.instanceCount, pointLightCount);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+        !out.write(reinterpret_cast<const char*>(texels.data()), texels.size() * sizeof(uint16_t)))
+    {
+        std::cout << "ERROR::LIGHTMAP::FAILED_TO_WRITE: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Uploads the atlas, false when the file is missing or was baked for another scene so the caller can light dynamically
+bool Lightmap::load(const char *path, unsigned int instanceCount, unsigned int pointLightCount)
+{
+    std::ifstream file(path, std::ios::binary);
+    LightmapHeader header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, LIGHTMAP_MAGIC, sizeof(LIGHTMAP_MAGIC)) != 0 || header.version != LIGHTMAP_VERSION)
+    {
+        std::cout << "ERROR::LIGHTMAP::FAILED_TO_READ: " << path << std::endl;
+        return false;
+    }
+    layout = lightmapLayout(header.instanceCount, header.faceTexels);
+    if (header.instanceCount != instanceCount || header.pointLightCount != pointLightCount ||
+        header.sceneHash != hashStaticLighting(instanceCount, pointLightCount) || header.faceTexels == 0 ||
+        header.width != layout.width || header.height != layout.height)
+    {
+        std::cout << "ERROR::LIGHTMAP::STALE: " << path << " was baked for " << header.instanceCount << " objects and "
+                  << header.pointLightCount << " lights" << std::endl;
+        return false;
+    }
+
+    int maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    std::vector<uint16_t> texels(static_cast<size_t>(layout.width) * layout.height * 4);
+    if (layout.width > static_cast<unsigned int>(maxSize) || layout.height > static_cast<unsigned int>(maxSize) ||
+        !file.read(reinterpret_cast<char*>(texels.data()), texels.size() * sizeof(uint16_t)))
+    {
+        std::cout << "ERROR::LIGHTMAP::INVALID_ATLAS: " << path << std::endl;
+        return false;
+    }
+
+    // Charts are padded for bilinear filtering only, mips would blend neighbouring cubes
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    labelObject(GL_TEXTURE, texture, "lightmap");
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, layout.width, layout.height, 0, GL_RGBA, GL_HALF_FLOAT, texels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// Adds the lightmap UVs to the cube VAO, instanced VAOs also get the per-instance atlas rectangles
+void Lightmap::attach(unsigned int VAO, bool isInstanced)
+{
+    glm::vec2 uvs[CUBE_VERTEX_COUNT];
+    buildCubeLightmapUVs(layout.faceTexels, uvs);
+
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &uvBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, uvBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(uvs), uvs, GL_STATIC_DRAW);
+    glVertexAttribPointer(LIGHTMAP_UV_LOCATION, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    glEnableVertexAttribArray(LIGHTMAP_UV_LOCATION);
+
+    if (isInstanced)
+    {
+        std::vector<glm::vec4> scaleOffsets(layout.instanceCount);
+        for (unsigned int i = 0; i < layout.instanceCount; i++)
+            scaleOffsets[i] = lightmapScaleOffset(layout, i);
+        glGenBuffers(1, &instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, scaleOffsets.size() * sizeof(glm::vec4), scaleOffsets.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(LIGHTMAP_INSTANCE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+        glEnableVertexAttribArray(LIGHTMAP_INSTANCE_LOCATION);
+        glVertexAttribDivisor(LIGHTMAP_INSTANCE_LOCATION, 1);
+    }
+    glBindVertexArray(0);
+}
+
+glm::vec4 Lightmap::getScaleOffset(unsigned int instance) const
+{
+    return lightmapScaleOffset(layout, instance);
+}
+
+void Lightmap::destroy()
+{
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &uvBuffer);
+    glDeleteBuffers(1, &instanceBuffer);
+    texture = uvBuffer = instanceBuffer = 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+#include "scene.h"
+
+// Written into the build directory by the bake_lightmap target, see tools/lightmap_bake.cpp
+const char* const LIGHTMAP_FILE_NAME = "lightmap.bin";
+const uint32_t LIGHTMAP_VERSION = 1;
+
+// Texels along one cube face chart and the padding around it, the padding is filled from the chart edge so
+// bilinear filtering never reads a neighbouring chart
+const unsigned int LIGHTMAP_FACE_TEXELS = 32;
+const unsigned int LIGHTMAP_GUTTER_TEXELS = 1;
+
+// Texture unit the atlas is bound to, after the diffuse and specular maps
+const unsigned int LIGHTMAP_TEXTURE_UNIT = 3;
+
+// Attribute locations of the baked cube shader, after the instanced transforms and material
+const unsigned int LIGHTMAP_UV_LOCATION = 11;
+const unsigned int LIGHTMAP_INSTANCE_LOCATION = 12;
+
+// Each cube gets a block of 3x2 face charts, blocks are placed row by row in a roughly square atlas
+struct LightmapLayout
+{
+    unsigned int faceTexels = 0;
+    unsigned int instanceCount = 0;
+    unsigned int columns = 0;
+    unsigned int blockWidth = 0;     // Texels per cube block
+    unsigned int blockHeight = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+};
+
+// File layout, native byte order: header, then width * height RGBA16F texels holding diffuse irradiance
+struct LightmapHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t faceTexels;
+    uint32_t instanceCount;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pointLightCount;
+    uint64_t sceneHash;
+};
+
+// Layout and unwrap, shared by the baker and the renderer so both agree on where every texel lives
+LightmapLayout lightmapLayout(unsigned int instanceCount, unsigned int faceTexels);
+glm::vec4 lightmapScaleOffset(const LightmapLayout &layout, unsigned int instance);
+void buildCubeLightmapUVs(unsigned int faceTexels, glm::vec2 uvs[CUBE_VERTEX_COUNT]);
+
+// Hash of the scene constants the bake depends on, a lightmap baked for other cubes or lights is rejected
+uint64_t hashStaticLighting(unsigned int instanceCount, unsigned int pointLightCount);
+
+bool writeLightmap(const char *path, const LightmapLayout &layout, unsigned int pointLightCount, const std::vector<uint16_t> &texels);
+
+// Baked direct and indirect lighting of the static lights for the cubes, sampled by cube_frag.glsl with BAKED_LIGHTING
+class Lightmap
+{
+    public:
+
+    LightmapLayout layout;
+    unsigned int texture = 0;
+
+    // Methods
+    bool load(const char *path, unsigned int instanceCount, unsigned int pointLightCount);
+    void attach(unsigned int VAO, bool isInstanced);
+    glm::vec4 getScaleOffset(unsigned int instance) const;
+    void destroy();
+
+    private:
+
+    unsigned int uvBuffer = 0;          // Mesh lightmap UVs
+    unsigned int instanceBuffer = 0;    // Per-instance scale and offset into the atlas
+};
+#endif
@@ -1,4 +1,8 @@
 #include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
@@ -6,10 +10,28 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.cpp"
 #include "camera.h"
-#include "stb_image.h"
+#include "camera_path.h"
+#include "benchmark.h"
+#include "headless.h"
+#include "profiler.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "gl_instrumentation.h"
+#include "gl_debug.h"
+#include "scene.h"
+#include "texture.h"
+#include "texture_loader.h"
+#include "material_array.h"
+#include "texture_residency.h"
+#include "image_allocator.h"
+#include "asset_io.h"
+#include "asset_pack.h"
+#include "lightmap.h"
+#include "light_probes.h"
 
 const unsigned int SCREEN_WIDTH = 1080;
 const unsigned int SCREEN_HEIGHT = 1080;
+const glm::vec3 BACKGROUND_COLOR = linearColor(glm::vec3(.8f, .55f, .3f));
 
 // NOTE: Make sure the executable is one directory down from project root (ie. something like '{root}/build/' minus the quotes)
 const char* VERTEX_FILE_PATH = "../vert.glsl";
@@ -17,6 +39,14 @@ const char* CUBE_FRAG_FILE_PATH = "../cube_frag.glsl";
 const char* LIGHT_FRAG_FILE_PATH = "../light_frag.glsl";
 const char* DIFFUSE_TEXTURE_PATH = "../assets/container2.png";
 const char* SPEC_TEXTURE_PATH = "../assets/container2_specular.png";
+const char* SPEC_COLOR_TEXTURE_PATH = "../assets/lighting_maps_specular_color.png";
+
+// Written into the build directory by the cook_textures target, the PNGs above are used when these are missing
+const char* DIFFUSE_COOKED_PATH = "assets/container2.ktx2";
+const char* SPEC_COOKED_PATH = "assets/container2_specular.ktx2";
+
+unsigned int viewportWidth = SCREEN_WIDTH;
+unsigned int viewportHeight = SCREEN_HEIGHT;
 
 float deltaTime = 0.f;
 float lastFrame = 0.f;
@@ -34,283 +64,675 @@ Camera camera = Camera(INITIAL_CAM_POS, glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f
 bool isFlashlightOn = false;
 bool canToggleFlashlight = true;
 
+// Camera path recording/replay
+CameraPath cameraPath;
+bool isRecording = false;
+bool isReplaying = false;
+size_t replayFrame = 0;
+uint32_t inputFlags = 0;
+
+// Benchmark
+bool isBenchmarking = false;
+
+// Scene load, swept by the benchmark matrix runner
+unsigned int objectCount = CUBE_COUNT;
+unsigned int pointLightCount = POINT_LIGHT_COUNT;
+bool isFlashlightForced = false;
+
+// Headless (no window, renders into an offscreen framebuffer)
+bool isHeadless = false;
+bool shouldClose = false;
+
+// Material array mode: maps packed into texture array layers, cubes drawn with one instanced call
+bool isMaterialArray = false;
+const char* MATERIAL_ARRAY_DEFINES = "#define INSTANCED\n#define MATERIAL_ARRAY\n";
+const std::vector<MaterialMaps> MATERIALS = {
+    { DIFFUSE_TEXTURE_PATH, SPEC_TEXTURE_PATH },
+    { DIFFUSE_TEXTURE_PATH, SPEC_COLOR_TEXTURE_PATH }
+};
+
+// Baked lighting: the static lights come from a lightmap atlas, only the flashlight is lit per fragment
+Lightmap lightmap;
+std::string lightmapPath = LIGHTMAP_FILE_NAME;
+bool isBakedLighting = false;
+const char* BAKED_LIGHTING_DEFINES = "#define BAKED_LIGHTING\n";
+
+// Probe lighting: bounce light comes from a baked irradiance probe grid in place of the per-light ambient terms
+LightProbes lightProbes;
+std::string lightProbePath = LIGHT_PROBE_FILE_NAME;
+bool isProbeLighting = false;
+const char* PROBE_LIGHTING_DEFINES = "#define PROBE_LIGHTING\n";
+
+// Startup files are read in one overlapped batch, texture requests add theirs as they are made
+AssetReader assetReader;
+
+// Shaders and textures come from the pack beside the executable when it exists, the loose paths above otherwise
+AssetPack assetPack;
+std::string assetPackPath;
+bool isAssetPackEnabled = true;
+
+// Textures are decoded on worker threads and uploaded within this per-frame budget
+AsyncTextureLoader textureLoader;
+const double TEXTURE_UPLOAD_BUDGET_MS = 2.0;
+
+// Imported images are kept here by content hash, warm runs map them instead of decoding the PNGs
+const char* TEXTURE_CACHE_DIRECTORY = "texture_cache";
+bool isTextureCacheEnabled = true;
+
+// Texture streaming: mip levels are kept under a VRAM budget instead of loading every texture fully resident
+TextureResidency textureResidency;
+bool isTextureStreaming = false;
+size_t textureBudgetBytes = 0;
+
+// Profiler
+Profiler profiler;
+bool canToggleOverlay = true;
+bool canToggleTrace = true;
+bool hasToggledTrace = false;
+
+// Default benchmark flythrough: orbit the cube cluster, then dive through it
+const std::vector<CameraKeyframe> BENCHMARK_KEYFRAMES = {
+    //  time   position                          yaw      pitch   fov
+    {   0.f,   glm::vec3( 0.f,  0.f,   3.f),    -90.f,    0.f,  45.f },
+    {   4.f,   glm::vec3( 6.f,  2.f,  -2.f),   -160.f,  -10.f,  45.f },
+    {   8.f,   glm::vec3( 0.f,  4.f, -14.f),   -270.f,  -15.f,  50.f },
+    {  12.f,   glm::vec3(-7.f,  1.f,  -6.f),   -380.f,   -5.f,  45.f },
+    {  16.f,   glm::vec3( 0.f, -1.f,   0.f),   -450.f,    5.f,  60.f },
+    {  20.f,   glm::vec3( 0.f,  0.f,   3.f),   -450.f,    0.f,  45.f }
+};
+
 void processInput(GLFWwindow *window);
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
 void mouseCallback(GLFWwindow *window, double xPos, double yPos);
 void scrollCallback(GLFWwindow *window, double xOffset, double yOffset);
-unsigned int loadTexture(char const *path);
+double getTime();
 
 /*
     TODO:
         - Move onto Model Loading!
 */
 
-int main()
+int main(int argc, char *argv[])
 {
-    // Initialize glfw
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Create window
-    GLFWwindow *window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "LearnOpenGL", NULL, NULL);
-    if (window == NULL)
+    // Parse arguments
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    const char *splinePath = NULL;
+    const char *screenshotPath = NULL;
+    const char *profileLogPath = NULL;
+    const char *tracePath = NULL;
+    GLDebugSettings debugSettings;
+    BenchmarkSettings benchmarkSettings;
+    double textureBudgetMiB = 0.0;
+
+    // Numbers are parsed like --size, a malformed value falls through to the usage text. sscanf's %u wraps negative
+    // input around instead of failing, so unsigned values with a '-' are rejected first.
+    for (int i = 1; i < argc; i++)
     {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (arg == "--replay-spline" && i + 1 < argc)
+            splinePath = argv[++i];
+        else if (arg == "--benchmark")
+            isBenchmarking = true;
+        else if (arg == "--warmup" && i + 1 < argc && argv[i + 1][0] != '-' &&
+                 std::sscanf(argv[i + 1], "%u", &benchmarkSettings.warmupFrames) == 1)
+            i++;
+        else if (arg == "--frames" && i + 1 < argc && argv[i + 1][0] != '-' &&
+                 std::sscanf(argv[i + 1], "%u", &benchmarkSettings.measuredFrames) == 1)
+            i++;
+        else if (arg == "--output" && i + 1 < argc)
+            benchmarkSettings.outputPrefix = argv[++i];
+        else if (arg == "--objects" && i + 1 < argc && argv[i + 1][0] != '-' &&
+                 std::sscanf(argv[i + 1], "%u", &objectCount) == 1 && objectCount > 0)
+            i++;
+        else if (arg == "--lights" && i + 1 < argc && argv[i + 1][0] != '-' &&
+                 std::sscanf(argv[i + 1], "%u", &pointLightCount) == 1 && pointLightCount > 0)
+        {
+            pointLightCount = std::min(pointLightCount, POINT_LIGHT_COUNT);
+            i++;
+        }
+        else if (arg == "--flashlight")
+            isFlashlightForced = isFlashlightOn = true;
+        else if (arg == "--material-array")
+            isMaterialArray = true;
+        else if (arg == "--baked")
+            isBakedLighting = true;
+        else if (arg == "--lightmap" && i + 1 < argc)
+        {
+            isBakedLighting = true;
+            lightmapPath = argv[++i];
+        }
+        else if (arg == "--light-probes")
+            isProbeLighting = true;
+        else if (arg == "--probe-grid" && i + 1 < argc)
+        {
+            isProbeLighting = true;
+            lightProbePath = argv[++i];
+        }
+        else if (arg == "--texture-budget" && i + 1 < argc && std::sscanf(argv[i + 1], "%lf", &textureBudgetMiB) == 1 && textureBudgetMiB >= 0.0)
+        {
+            isTextureStreaming = true;
+            textureBudgetBytes = static_cast<size_t>(textureBudgetMiB * 1024.0 * 1024.0);
+            i++;
+        }
+        else if (arg == "--no-texture-cache")
+            isTextureCacheEnabled = false;
+        else if (arg == "--asset-pack" && i + 1 < argc)
+            assetPackPath = argv[++i];
+        else if (arg == "--no-asset-pack")
+            isAssetPackEnabled = false;
+        else if (arg == "--headless")
+            isHeadless = true;
+        else if (arg == "--size" && i + 1 < argc && !std::strchr(argv[i + 1], '-') &&
+                 std::sscanf(argv[i + 1], "%ux%u", &viewportWidth, &viewportHeight) == 2)
+            i++;
+        else if (arg == "--screenshot" && i + 1 < argc)
+            screenshotPath = argv[++i];
+        else if (arg == "--profile")
+            profiler.showOverlay = true;
+        else if (arg == "--profile-log" && i + 1 < argc)
+            profileLogPath = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--hitch-factor" && i + 1 < argc && std::sscanf(argv[i + 1], "%f", &flightRecorder.hitchFactor) == 1)
+            i++;
+        else if (arg == "--no-flight-recorder")
+            flightRecorder.isEnabled = false;
+        else if (arg == "--gl-debug")
+            debugSettings.isEnabled = true;
+        else if (arg == "--gl-debug-perf")
+            debugSettings.isEnabled = debugSettings.isPerformanceOnly = true;
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [--record <file>] [--replay <file>] [--replay-spline <keyframes>]\n"
+                      << "       [--benchmark [--warmup <frames>] [--frames <frames>] [--output <prefix>]]\n"
+                      << "       [--objects <count>] [--lights <1-" << POINT_LIGHT_COUNT << ">] [--flashlight] [--material-array]\n"
+                      << "       [--baked] [--lightmap <file>] [--light-probes] [--probe-grid <file>]\n"
+                      << "       [--texture-budget <MiB>] [--no-texture-cache] [--asset-pack <file>] [--no-asset-pack]\n"
+                      << "       [--headless] [--size <width>x<height>] [--screenshot <file.ppm>]\n"
+                      << "       [--profile] [--profile-log <file.csv>] [--trace <file.json>]\n"
+                      << "       [--hitch-factor <k>] [--no-flight-recorder] [--gl-debug] [--gl-debug-perf]" << std::endl;
+            return -1;
+        }
     }
-    glfwMakeContextCurrent(window);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    // Register functions
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-    glfwSetCursorPosCallback(window, mouseCallback);
-    glfwSetScrollCallback(window, scrollCallback);
+    // Load camera path
+    if (replayPath && !cameraPath.load(replayPath))
+        return -1;
+    if (splinePath && !cameraPath.loadKeyframes(splinePath))
+        return -1;
+    if (isBenchmarking && !replayPath && !splinePath && !cameraPath.buildFromKeyframes(BENCHMARK_KEYFRAMES))
+        return -1;
+    isReplaying = replayPath || splinePath || isBenchmarking;
 
-    // Load functions
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    // Replay indexes the path modulo its length, an empty one has nothing to show
+    if (isReplaying && cameraPath.size() == 0)
     {
-        std::cout << "Failed to initialize GLAD" << std::endl;
+        std::cout << "ERROR::CAMERA_PATH::EMPTY" << std::endl;
         return -1;
     }
+    isRecording = recordPath && !isReplaying && !isHeadless;
+    Benchmark benchmark(benchmarkSettings);
 
-    // Create Shader Programs
-    Shader cubeShader(VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH);
-    Shader lightShader(VERTEX_FILE_PATH, LIGHT_FRAG_FILE_PATH);
-
-    // Verticies of a cube
-    float vertices[] = {
-        // Position          // Normal            // Texture Coordinates
-       -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-        0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-        0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-        0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-       -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-       -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-
-       -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-        0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
-        0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-        0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-       -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
-       -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-
-       -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-       -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-       -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-       -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-       -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-       -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-        0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-        0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-        0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-        0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-        0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-        0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-       -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-        0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
-        0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-        0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-       -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
-       -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-
-       -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
-        0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
-        0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-        0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-       -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
-       -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
-    };
-
-    // Cube positions
-    glm::vec3 cubePositions[] = {
-        glm::vec3( 0.0f,  0.0f,  0.0f),
-        glm::vec3( 2.0f,  5.0f, -15.0f),
-        glm::vec3(-1.5f, -2.2f, -2.5f),
-        glm::vec3(-3.8f, -2.0f, -12.3f),
-        glm::vec3( 2.4f, -0.4f, -3.5f),
-        glm::vec3(-1.7f,  3.0f, -7.5f),
-        glm::vec3( 1.3f, -2.0f, -2.5f),
-        glm::vec3( 1.5f,  2.0f, -2.5f),
-        glm::vec3( 1.5f,  0.2f, -1.5f),
-        glm::vec3(-1.3f,  1.0f, -1.5f)
-    };
-
-    // Point light positions
-    glm::vec3 pointLightPositions[] = {
-        glm::vec3(0.7f,  0.2f,  2.0f),
-        glm::vec3(2.3f, -3.3f, -4.0f),
-        glm::vec3(-4.0f,  2.0f, -12.0f),
-        glm::vec3(0.0f,  0.0f, -3.0f)
-    };
-
-    glm::vec3 pointLightColors[] = {
-        glm::vec3(1.f, 1.f, .2f),
-        glm::vec3(1.f, .15f, .0f),
-        glm::vec3(1.f, 1.f, 1.f),
-        glm::vec3(0.f, 0.2f, 1.f)
-    };
+    GLFWwindow *window = NULL;
+    HeadlessContext headless;
+    GLADloadproc loader = isHeadless ? (GLADloadproc)HeadlessContext::getProcAddress : (GLADloadproc)glfwGetProcAddress;
+    if (isHeadless)
+    {
+        // Create offscreen context, GLFW is never initialized
+        if (!headless.init(viewportWidth, viewportHeight, debugSettings.isEnabled))
+            return -1;
+        if (!gladLoadGLLoader(loader) || !headless.initFramebuffer())
+        {
+            std::cout << "Failed to initialize headless context" << std::endl;
+            headless.destroy();
+            return -1;
+        }
+    }
+    else
+    {
+        // Initialize glfw
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, debugSettings.isEnabled ? GLFW_TRUE : GLFW_FALSE);
+        glfwWindowHint(GLFW_SRGB_CAPABLE, GLFW_TRUE);
+        if (isBenchmarking)
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        // Create window
+        window = glfwCreateWindow(viewportWidth, viewportHeight, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        if (isBenchmarking)
+            glfwSwapInterval(0);
+        else
+            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        // Register functions
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+        glfwSetCursorPosCallback(window, mouseCallback);
+        glfwSetScrollCallback(window, scrollCallback);
+
+        // Load functions
+        if (!gladLoadGLLoader(loader))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+    }
+    installGLInstrumentation();
+    initGLDebug(loader, debugSettings);
+    if (isHeadless)
+        labelObject(GL_FRAMEBUFFER, headless.framebuffer, "headless framebuffer");
+    if (isBenchmarking)
+        benchmark.init();
+    profiler.init();
+    if (profileLogPath && !profiler.openLog(profileLogPath))
+        return -1;
+    tracer.setEnabled(tracePath != NULL);
 
-    // -- Cube VAO --
-    unsigned int VBO, cubeVAO;
-    glGenVertexArrays(1, &cubeVAO);
-    glBindVertexArray(cubeVAO);
+    // Map the pack once, a missing default pack just means the loose files are used
+    if (isAssetPackEnabled)
+    {
+        if (assetPackPath.empty())
+            assetPackPath = defaultAssetPackPath();
+        if (assetPack.open(assetPackPath.c_str()))
+            std::cout << "Asset pack: " << assetPackPath << ", " << assetPack.getEntryCount() << " entries" << std::endl;
+    }
+
+    // Queue the shader sources that are not packed, they are read while the textures are requested and the material arrays built
+    assetReader.init();
+    const char *shaderPaths[] = { VERTEX_FILE_PATH, CUBE_FRAG_FILE_PATH, LIGHT_FRAG_FILE_PATH };
+    std::string shaderSources[3];
+    unsigned int shaderReads[3];
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        AssetSpan span;
+        shaderReads[i] = ASSET_READ_NONE;
+        if (assetPack.find(shaderPaths[i], span))
+            shaderSources[i].assign(reinterpret_cast<const char*>(span.data), span.size);
+        else
+            shaderReads[i] = assetReader.read(shaderPaths[i], shaderSources[i]);
+    }
+    assetReader.submit();
+
+    // Create lighting maps, the placeholder is bound until they are uploaded
+    // Streamed textures start with only their smallest levels resident
+    textureLoader.init(0, isTextureCacheEnabled ? TEXTURE_CACHE_DIRECTORY : nullptr, &assetReader, &assetPack);
+    unsigned int diffuseMap, specularMap;
+    if (isTextureStreaming)
+    {
+        textureResidency.init(textureBudgetBytes, &assetPack);
+        diffuseMap = textureResidency.add(DIFFUSE_TEXTURE_PATH, DIFFUSE_COOKED_PATH, TEXTURE_USAGE_COLOR);
+        specularMap = textureResidency.add(SPEC_TEXTURE_PATH, SPEC_COOKED_PATH, TEXTURE_USAGE_DATA);
+    }
+    else
+    {
+        diffuseMap = textureLoader.request(DIFFUSE_TEXTURE_PATH, DIFFUSE_COOKED_PATH, TEXTURE_USAGE_COLOR);
+        specularMap = textureLoader.request(SPEC_TEXTURE_PATH, SPEC_COOKED_PATH, TEXTURE_USAGE_DATA);
+    }
+
+    // Pack material maps into texture arrays
+    MaterialArray materialArray;
+    if (isMaterialArray && !materialArray.build(MATERIALS, &assetPack))
+    {
+        std::cout << "Material arrays unavailable, binding material maps per draw" << std::endl;
+        isMaterialArray = false;
+    }
 
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // Baked lighting needs a lightmap for exactly this scene, otherwise every light stays per fragment
+    if (isBakedLighting && !lightmap.load(lightmapPath.c_str(), objectCount, pointLightCount))
+    {
+        std::cout << "Lightmap unavailable, lighting every fragment" << std::endl;
+        isBakedLighting = false;
+    }
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);   // Position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float))); // Normals
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float))); // Texture Coordinates
-    glEnableVertexAttribArray(2);
+    // The lightmap already holds the bounce light, probes only light scenes that are otherwise per fragment
+    if (isProbeLighting && isBakedLighting)
+    {
+        std::cout << "Lightmap holds the bounce light, ignoring the light probes" << std::endl;
+        isProbeLighting = false;
+    }
+    if (isProbeLighting && !lightProbes.load(lightProbePath.c_str(), objectCount, pointLightCount))
+    {
+        std::cout << "Light probes unavailable, keeping the ambient terms" << std::endl;
+        isProbeLighting = false;
+    }
+
+    // Create Shader Programs
+    for (unsigned int i = 0; i < 3; i++)
+        if (shaderReads[i] != ASSET_READ_NONE && !assetReader.wait(shaderReads[i]))
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << shaderPaths[i] << std::endl;
+    // One cube variant per flashlight state, disabled lights and the point light loop bound are compiled in
+    std::string cubeDefines = std::string(isMaterialArray ? MATERIAL_ARRAY_DEFINES : "") + (isBakedLighting ? BAKED_LIGHTING_DEFINES : "") +
+                              (isProbeLighting ? PROBE_LIGHTING_DEFINES : "");
+    unsigned int livePointLights = isBakedLighting ? 0 : pointLightCount;
+    Shader darkCubeShader = Shader::fromSource(shaderSources[0], shaderSources[1], cubeDefines + lightingDefines(livePointLights, false));
+    Shader litCubeShader = Shader::fromSource(shaderSources[0], shaderSources[1], cubeDefines + lightingDefines(livePointLights, true));
+    Shader lightShader = Shader::fromSource(shaderSources[0], shaderSources[2]);
+    labelObject(GL_PROGRAM, darkCubeShader.ID, "cube shader");
+    labelObject(GL_PROGRAM, litCubeShader.ID, "cube shader (flashlight)");
+    labelObject(GL_PROGRAM, lightShader.ID, "light shader");
+
+    // -- Cube VAO --
+    unsigned int VBO, lightVBO;
+    unsigned int cubeVAO = createCubeVAO(VBO, true);
+    labelObject(GL_VERTEX_ARRAY, cubeVAO, "cube VAO");
+    labelObject(GL_BUFFER, VBO, "cube vertices");
 
     // -- Light VAO --
-    unsigned int lightVAO;
-    glGenVertexArrays(1, &lightVAO);
-    glBindVertexArray(lightVAO);
+    unsigned int lightVAO = createCubeVAO(lightVBO, false);
+    labelObject(GL_VERTEX_ARRAY, lightVAO, "light VAO");
+    labelObject(GL_BUFFER, lightVBO, "light vertices");
 
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // -- Cube instances --
+    unsigned int instanceVBO = 0;
+    if (isMaterialArray)
+    {
+        instanceVBO = createCubeInstanceBuffer(cubeVAO, objectCount, materialArray.layerCount);
+        labelObject(GL_BUFFER, instanceVBO, "cube instances");
+    }
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);   // Position
-    glEnableVertexAttribArray(0);
+    // -- Lightmap UVs --
+    if (isBakedLighting)
+        lightmap.attach(cubeVAO, isMaterialArray);
 
-    // Create lighting maps
-    unsigned int diffuseMap = loadTexture(DIFFUSE_TEXTURE_PATH);
-    unsigned int specularMap = loadTexture(SPEC_TEXTURE_PATH);
+    // Runs that measure or capture frames start with every texture resident
+    if (isBenchmarking || isHeadless)
+        textureLoader.finish();
 
     // Enable depth testing
     glEnable(GL_DEPTH_TEST);
 
+    // Colour maps are decoded to linear when sampled, so encode back to sRGB on write
+    glEnable(GL_FRAMEBUFFER_SRGB);
+
     // Render loop
-    while (!glfwWindowShouldClose(window))
+    while (!shouldClose && !(window && glfwWindowShouldClose(window)))
     {
-        // Delta time
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        renderStats = RenderStats();
+        flightRecorder.beginFrame();
+        if (isBenchmarking)
+            benchmark.beginFrame();
+        profiler.beginFrame();
+        profiler.beginScope("frame");
+
+        // Delta time (fixed while replaying so every run renders the same frames)
+        float currentFrame = getTime();
+        deltaTime = isReplaying ? cameraPath.timestep : currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput(window);
+        profiler.beginScope("input");
+        if (window)
+            processInput(window);
+
+        // Drive camera from the recorded path
+        if (isReplaying)
+        {
+            // Benchmarks loop the path until enough frames are measured, plain replays stop once this frame is finished
+            if (isBenchmarking)
+                replayFrame %= cameraPath.size();
+            cameraPath.apply(replayFrame, camera);
+            isFlashlightOn = isFlashlightForced || (cameraPath.frames[replayFrame].inputFlags & INPUT_FLASHLIGHT) != 0;
+            replayFrame++;
+            if (!isBenchmarking && replayFrame >= cameraPath.size())
+                shouldClose = true;
+        }
+
+        camera.update(deltaTime);
+
+        if (isRecording)
+            cameraPath.record(camera, inputFlags | (isFlashlightOn ? INPUT_FLASHLIGHT : 0u));
+        profiler.endScope();
+
+        profiler.beginScope("texture uploads");
+        if (isTextureStreaming)
+        {
+            // Cube faces are one unit across, the closest cube decides the finest level needed
+            float closest = 100.f;
+            for (unsigned int i = 0; i < objectCount; i++)
+                closest = std::min(closest, glm::distance(camera.position, glm::vec3(cubeModelMatrix(i)[3])) - .5f);
+            float cubePixels = projectedPixels(1.f, closest, glm::radians(camera.fov), viewportHeight);
+            textureResidency.touch(diffuseMap, cubePixels);
+            textureResidency.touch(specularMap, cubePixels);
+            textureResidency.update(TEXTURE_UPLOAD_BUDGET_MS);
+        }
+        else
+            textureLoader.update(TEXTURE_UPLOAD_BUDGET_MS);
+        profiler.endScope();
         
-        glClearColor(.8f, .55f, .3f, 1.f);
+        profiler.beginScope("clear");
+        glClearColor(BACKGROUND_COLOR.r, BACKGROUND_COLOR.g, BACKGROUND_COLOR.b, 1.f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        profiler.endScope();
         
         // Activate cube shader
+        profiler.beginScope("uniforms");
+        Shader &cubeShader = isFlashlightOn ? litCubeShader : darkCubeShader;
         cubeShader.use();
         
         // Cube lighting maps
         cubeShader.setInt("material.diffuse", 0);
         cubeShader.setInt("material.specular", 1);
-        cubeShader.setInt("material.emission", 2);
         cubeShader.setFloat("material.shininess", 64.f);
+        if (isMaterialArray)
+        {
+            cubeShader.setInt("diffuseArray", 0);
+            cubeShader.setInt("specularArray", 1);
+        }
+        if (isBakedLighting)
+            cubeShader.setInt("lightmap", LIGHTMAP_TEXTURE_UNIT);
+        if (isProbeLighting)
+        {
+            const ProbeGridLayout &grid = lightProbes.layout;
+            cubeShader.setInt("probeGrid", LIGHT_PROBE_TEXTURE_UNIT);
+            cubeShader.setVec3("probeGridMin", grid.min);
+            cubeShader.setFloat("probeGridSpacing", grid.spacing);
+            cubeShader.setVec3("probeGridCounts", glm::vec3(static_cast<float>(grid.countX), static_cast<float>(grid.countY), static_cast<float>(grid.countZ)));
+        }
 
         // Direcitonal lighting
-        cubeShader.setVec3("dirLight.direction", glm::vec3(-.2f, -1.f, -.3f));
+        cubeShader.setVec3("dirLight.direction", DIR_LIGHT_DIRECTION);
         cubeShader.setVec3("dirLight.ambient", glm::vec3(.0f));
-        cubeShader.setVec3("dirLight.diffuse", glm::vec3(.4f));
-        cubeShader.setVec3("dirLight.specular", glm::vec3(.5f));
+        cubeShader.setVec3("dirLight.diffuse", DIR_LIGHT_DIFFUSE);
+        cubeShader.setVec3("dirLight.specular", DIR_LIGHT_SPECULAR);
 
-        // Point lighting
-        for (unsigned int i = 0; i < 4; i++)
+        // Point lighting, the baked variants have none
+        for (unsigned int i = 0; i < livePointLights; i++)
         {
             std::stringstream uniformName;
             uniformName << "pointLights[" << i << "].";
 
-            cubeShader.setVec3(uniformName.str() + "position", pointLightPositions[i]);
-            cubeShader.setVec3(uniformName.str() + "ambient", pointLightColors[i] * 0.1f);
-            cubeShader.setVec3(uniformName.str() + "diffuse", pointLightColors[i]);
-            cubeShader.setVec3(uniformName.str() + "specular", pointLightColors[i]);
-            cubeShader.setFloat(uniformName.str() + "constant", 1.f);
-            cubeShader.setFloat(uniformName.str() + "linear", .09f);
-            cubeShader.setFloat(uniformName.str() + "quadratic", .032f);
+            cubeShader.setVec3(uniformName.str() + "position", POINT_LIGHT_POSITIONS[i]);
+            cubeShader.setVec3(uniformName.str() + "ambient", POINT_LIGHT_COLORS[i] * 0.1f);
+            cubeShader.setVec3(uniformName.str() + "diffuse", POINT_LIGHT_COLORS[i]);
+            cubeShader.setVec3(uniformName.str() + "specular", POINT_LIGHT_COLORS[i]);
+            cubeShader.setFloat(uniformName.str() + "constant", LIGHT_CONSTANT);
+            cubeShader.setFloat(uniformName.str() + "linear", LIGHT_LINEAR);
+            cubeShader.setFloat(uniformName.str() + "quadratic", LIGHT_QUADRATIC);
         }
 
-        // Spotlight
-        cubeShader.setVec3("spotLight.position", camera.position);
-        cubeShader.setVec3("spotLight.direction", camera.getFront());
-        cubeShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(8.5f)));
-        cubeShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(11.5f)));
-        cubeShader.setFloat("spotLight.constant", 1.f);
-        cubeShader.setFloat("spotLight.linear", .09f);
-        cubeShader.setFloat("spotLight.quadratic", .032f);
-        cubeShader.setVec3("spotLight.ambient", glm::vec3(.05f) * static_cast<float>(isFlashlightOn));
-        cubeShader.setVec3("spotLight.diffuse", glm::vec3(2.f) * static_cast<float>(isFlashlightOn));
-        cubeShader.setVec3("spotLight.specular", glm::vec3(1.f) * static_cast<float>(isFlashlightOn));
+        // Spotlight, only the flashlight variant has it
+        if (isFlashlightOn)
+        {
+            cubeShader.setVec3("spotLight.position", camera.position);
+            cubeShader.setVec3("spotLight.direction", camera.getFront());
+            cubeShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(8.5f)));
+            cubeShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(11.5f)));
+            cubeShader.setFloat("spotLight.constant", LIGHT_CONSTANT);
+            cubeShader.setFloat("spotLight.linear", LIGHT_LINEAR);
+            cubeShader.setFloat("spotLight.quadratic", LIGHT_QUADRATIC);
+            cubeShader.setVec3("spotLight.ambient", glm::vec3(.05f));
+            cubeShader.setVec3("spotLight.diffuse", glm::vec3(2.f));
+            cubeShader.setVec3("spotLight.specular", glm::vec3(1.f));
+        }
 
         // Cube transformations
         glm::mat4 model = glm::mat4(1.f);
-        glm::mat3 normalModel = glm::transpose(glm::inverse(model));
+        glm::mat3 normalModel = normalMatrix(model);
         glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 projection = glm::perspective(glm::radians(camera.fov), static_cast<float>(SCREEN_WIDTH) / SCREEN_HEIGHT, 0.1f, 100.f);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.fov), static_cast<float>(viewportWidth) / viewportHeight, 0.1f, 100.f);
         cubeShader.setMat4("model", model);
         cubeShader.setMat4("view", view);
         cubeShader.setMat4("projection", projection);
         cubeShader.setMat3("normalModel", normalModel);
         cubeShader.setVec3("viewPos", camera.position);
+        profiler.endScope();
         
-        // Cube textures
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, specularMap);
-
         // Render cubes
+        profiler.beginScope("cubes");
         glBindVertexArray(cubeVAO);
-        for (unsigned int i = 0; i < 10; i++)
+        if (isBakedLighting)
         {
-            float angle = 20.f * i;
-            model = glm::mat4(1.f);
-            model = glm::translate(model, cubePositions[i]);
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.f, .3f, .5f));
-            normalModel = glm::transpose(glm::inverse(model));
-
-            cubeShader.setMat4("model", model);
-            cubeShader.setMat3("normalModel", normalModel);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+            glBindTexture(GL_TEXTURE_2D, lightmap.texture);
+        }
+        if (isProbeLighting)
+        {
+            glActiveTexture(GL_TEXTURE0 + LIGHT_PROBE_TEXTURE_UNIT);
+            glBindTexture(GL_TEXTURE_3D, lightProbes.texture);
         }
+        if (isMaterialArray)
+        {
+            // Transforms and material layers come from the instance buffer
+            materialArray.bind(0, 1);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, objectCount);
+        }
+        else
+        {
+            // Cube textures
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, isTextureStreaming ? textureResidency.getTexture(diffuseMap) : textureLoader.getTexture(diffuseMap));
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, isTextureStreaming ? textureResidency.getTexture(specularMap) : textureLoader.getTexture(specularMap));
+
+            for (unsigned int i = 0; i < objectCount; i++)
+            {
+                model = cubeModelMatrix(i);
+                normalModel = normalMatrix(model);
+
+                cubeShader.setMat4("model", model);
+                cubeShader.setMat3("normalModel", normalModel);
+                if (isBakedLighting)
+                    cubeShader.setVec4("lightmapScaleOffset", lightmap.getScaleOffset(i));
+
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+        profiler.endScope();
 
         // Render point light cubes
+        profiler.beginScope("light cubes");
         glBindVertexArray(lightVAO);
-        size_t pointLightCount = sizeof(pointLightPositions) / sizeof(pointLightPositions[0]);
         for (unsigned int i = 0; i < pointLightCount; i++)
         {
-            model = glm::mat4(1.f);
-            model = glm::translate(model, pointLightPositions[i]);
-            model = glm::scale(model, glm::vec3(.5f));
+            model = lightModelMatrix(i);
 
             lightShader.use();
             lightShader.setMat4("model", model);
             lightShader.setMat4("view", view);
             lightShader.setMat4("projection", projection);
-            lightShader.setVec3("lightColor", pointLightColors[i]);
+            lightShader.setVec3("lightColor", POINT_LIGHT_COLORS[i]);
 
             glDrawArrays(GL_TRIANGLES, 0, 36);
         }
+        profiler.endScope();
+
+        profiler.drawOverlay(viewportWidth, viewportHeight);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Headless renders a single frame unless a path or benchmark drives it
+        profiler.beginScope("swap");
+        if (window)
+        {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        else
+        {
+            glFlush();
+            if (!isReplaying)
+                shouldClose = true;
+        }
+        profiler.endScope();
+        profiler.endScope();
+        profiler.endFrame();
+        flightRecorder.endFrame(renderStats);
+
+        if (isBenchmarking)
+        {
+            benchmark.endFrame();
+            if (benchmark.isFinished())
+                shouldClose = true;
+        }
     }
 
+    // Save last rendered frame
+    if (screenshotPath)
+    {
+        if (window)
+            glReadBuffer(GL_FRONT);
+        writeFramebufferPPM(screenshotPath, viewportWidth, viewportHeight);
+    }
+
+    // Write benchmark results
+    bool succeeded = !isBenchmarking || benchmark.writeResults();
+
+    // Save recorded path
+    if (isRecording && !cameraPath.save(recordPath))
+        std::cout << "ERROR::Failed to save camera path to: " << recordPath << std::endl;
+
+    // Export trace
+    if (tracePath || hasToggledTrace)
+        tracer.writeChromeTrace(tracePath ? tracePath : "trace.json");
+
     // Clean up
+    printGLDebugSummary();
+    if (isTextureStreaming)
+        textureResidency.printStats();
+    else
+    {
+        textureLoader.printStats();
+        printImageAllocatorStats();
+        textureLoader.release(diffuseMap);
+        textureLoader.release(specularMap);
+    }
+    profiler.destroy();
+    textureLoader.destroy();
+    textureResidency.destroy();
+    assetReader.printStats();
+    assetReader.destroy();
+    assetPack.close();
     glDeleteVertexArrays(1, &cubeVAO);
     glDeleteVertexArrays(1, &lightVAO);
     glDeleteBuffers(1, &VBO);
-    glfwTerminate();
-    return 0;
+    glDeleteBuffers(1, &lightVBO);
+    glDeleteBuffers(1, &instanceVBO);
+    materialArray.destroy();
+    lightmap.destroy();
+    lightProbes.destroy();
+    if (isHeadless)
+        headless.destroy();
+    else
+        glfwTerminate();
+    return succeeded ? 0 : -1;
 }
 
 // Set viewport whenever the window resizes
 void framebufferSizeCallback(GLFWwindow *window, int width, int height)
 {
+    viewportWidth = width;
+    viewportHeight = height;
     glViewport(0, 0, width, height);
 }
 
@@ -320,36 +742,85 @@ void processInput(GLFWwindow *window)
     // Quit
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+    // Toggle profiler overlay
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && canToggleOverlay)
+    {
+        canToggleOverlay = false;
+        profiler.showOverlay = !profiler.showOverlay;
+    }
+    else if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE)
+        canToggleOverlay = true;
+
+    // Toggle trace recording
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && canToggleTrace)
+    {
+        canToggleTrace = false;
+        hasToggledTrace = true;
+        tracer.setEnabled(!tracer.isEnabled());
+    }
+    else if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+        canToggleTrace = true;
+
+    // Camera is driven by the path while replaying
+    inputFlags = 0;
+    if (isReplaying)
+        return;
     
     // Strafing
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    {
         camera.processKeyboard(Camera_Movement::FORWARD, deltaTime);
+        inputFlags |= INPUT_FORWARD;
+    }
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    {
         camera.processKeyboard(Camera_Movement::BACKWARD, deltaTime);
+        inputFlags |= INPUT_BACKWARD;
+    }
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    {
         camera.processKeyboard(Camera_Movement::LEFT, deltaTime);
+        inputFlags |= INPUT_LEFT;
+    }
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    {
         camera.processKeyboard(Camera_Movement::RIGHT, deltaTime);
+        inputFlags |= INPUT_RIGHT;
+    }
 
     // Sprinting
     if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    {
         camera.isSprinting = true;
+        inputFlags |= INPUT_SPRINT;
+    }
     else
         camera.isSprinting = false;
 
     // Vertical Movement
     if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS)
+    {
         camera.processKeyboard(Camera_Movement::UP, deltaTime);
+        inputFlags |= INPUT_UP;
+    }
     if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS)
+    {
         camera.processKeyboard(Camera_Movement::DOWN, deltaTime);
+        inputFlags |= INPUT_DOWN;
+    }
     
     // Focus on cube
     if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
+    {
         camera.lookAtPosition(glm::vec3(0.f));
+        inputFlags |= INPUT_FOCUS;
+    }
 
     // Reset position and rotation
     if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
     {
+        inputFlags |= INPUT_RESET;
         camera.position = INITIAL_CAM_POS;
         camera.lookAtPosition(glm::vec3(0.f));
     }
@@ -367,6 +838,9 @@ void processInput(GLFWwindow *window)
 // Rotate camera using mouse
 void mouseCallback(GLFWwindow *window, double xPos, double yPos)
 {
+    if (isReplaying)
+        return;
+
     // Avoid jerking within the first frame
     if (firstMouse)
     {
@@ -386,54 +860,15 @@ void mouseCallback(GLFWwindow *window, double xPos, double yPos)
 // Control zoom using mouse scroll
 void scrollCallback(GLFWwindow *window, double xOffset, double yOffset)
 {
+    if (isReplaying)
+        return;
+
     camera.processMouseScroll(static_cast<float>(yOffset));
 }
 
-// Load texture
-unsigned int loadTexture(char const* path)
+// Seconds since the first call, monotonic and independent of GLFW
+double getTime()
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        switch (nrComponents)
-        {
-            case 1:
-                format = GL_RED;
-                break;
-            case 2:
-                format = GL_RG;
-                break;
-            case 3:
-                format = GL_RGB;
-                break;
-            case 4:
-                format = GL_RGBA;
-                break;
-            default:
-                format = GL_RGB;
-                break;
-        }
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "ERROR::Failed to load texture at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
\ No newline at end of file
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
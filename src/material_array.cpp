@@ -0,0 +1,94 @@
+#include <iostream>
+#include "glad/glad.h"
+#include "material_array.h"
+#include "texture.h"
+#include "stb_image.h"
+#include "image_allocator.h"
+#include "gl_debug.h"
+
+// Requires a current GL context, every map has to match the size of the first one. Maps are read from pack when it has them.
+bool MaterialArray::build(const std::vector<MaterialMaps> &materials, const AssetPack *pack)
+{
+    destroy();
+    std::vector<const char*> diffusePaths, specularPaths;
+    for (const MaterialMaps &material : materials)
+    {
+        diffusePaths.push_back(material.diffusePath);
+        specularPaths.push_back(material.specularPath);
+    }
+
+    diffuseArray = createArray(diffusePaths, "diffuse array", GL_SRGB8_ALPHA8, pack);
+    specularArray = diffuseArray ? createArray(specularPaths, "specular array", GL_RGBA8, pack) : 0;
+    if (!diffuseArray || !specularArray)
+    {
+        destroy();
+        return false;
+    }
+    layerCount = static_cast<unsigned int>(materials.size());
+    return true;
+}
+
+void MaterialArray::bind(unsigned int diffuseUnit, unsigned int specularUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + diffuseUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, diffuseArray);
+    glActiveTexture(GL_TEXTURE0 + specularUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, specularArray);
+}
+
+void MaterialArray::destroy()
+{
+    glDeleteTextures(1, &diffuseArray);
+    glDeleteTextures(1, &specularArray);
+    diffuseArray = specularArray = layerCount = 0;
+    width = height = 0;
+}
+
+// Decodes every map to RGBA8 and uploads it into its own layer, colour arrays are stored as sRGB
+unsigned int MaterialArray::createArray(const std::vector<const char*> &paths, const char *label, unsigned int internalFormat, const AssetPack *pack)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    labelObject(GL_TEXTURE, textureID, label);
+
+    for (size_t layer = 0; layer < paths.size(); layer++)
+    {
+        int layerWidth, layerHeight, nrComponents;
+        unsigned char *data = decodeAssetImage(pack, paths[layer], &layerWidth, &layerHeight, &nrComponents, 4);
+        if (!data)
+        {
+            std::cout << "ERROR::MATERIAL_ARRAY::FAILED_TO_LOAD: " << paths[layer] << std::endl;
+            glDeleteTextures(1, &textureID);
+            return 0;
+        }
+        if (width == 0)
+        {
+            width = layerWidth;
+            height = layerHeight;
+        }
+        if (layerWidth != width || layerHeight != height)
+        {
+            std::cout << "ERROR::MATERIAL_ARRAY::SIZE_MISMATCH: " << paths[layer] << " is " << layerWidth << "x" << layerHeight
+                      << ", layers are " << width << "x" << height << std::endl;
+            stbi_image_free(data);
+            glDeleteTextures(1, &textureID);
+            return 0;
+        }
+
+        GLsizei layers = static_cast<GLsizei>(paths.size());
+        if (layer == 0 && hasTextureStorage())
+            glTexStorage3D(GL_TEXTURE_2D_ARRAY, textureLevelCount(width, height), internalFormat, width, height, layers);
+        else if (layer == 0)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(layer), width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        stbi_image_free(data);
+    }
+
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return textureID;
+}
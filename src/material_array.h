@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef MATERIAL_ARRAY_H
+#define MATERIAL_ARRAY_H
+
+#include <vector>
+#include "asset_pack.h"
+
+struct MaterialMaps
+{
+    const char *diffusePath;
+    const char *specularPath;
+};
+
+// Material maps packed into GL_TEXTURE_2D_ARRAY layers (layer i holds material i), so every
+// material in a pass is sampled from the same two bindings and cubes draw in one instanced call
+class MaterialArray
+{
+    public:
+
+    unsigned int diffuseArray = 0;
+    unsigned int specularArray = 0;
+    unsigned int layerCount = 0;
+    int width = 0;
+    int height = 0;
+
+    // Methods
+    bool build(const std::vector<MaterialMaps> &materials, const AssetPack *pack = nullptr);
+    void bind(unsigned int diffuseUnit, unsigned int specularUnit) const;
+    void destroy();
+
+    private:
+
+    unsigned int createArray(const std::vector<const char*> &paths, const char *label, unsigned int internalFormat, const AssetPack *pack);
+};
+#endif
@@ -0,0 +1,235 @@
+#include <iostream>
+#include <cstring>
+#include "profiler.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "gl_debug.h"
+#include "texture.h"
+
+// Frames between GL_TIMESTAMP recalibrations of the trace GPU clock
+const unsigned int TRACE_CALIBRATION_INTERVAL = 120;
+
+void RollingAverage::add(double value)
+{
+    if (count == PROFILER_HISTORY)
+        sum -= samples[head];
+    else
+        count++;
+
+    samples[head] = value;
+    sum += value;
+    last = value;
+    head = (head + 1) % PROFILER_HISTORY;
+}
+
+double RollingAverage::average() const
+{
+    return count ? sum / count : 0.0;
+}
+
+// Requires a current GL context
+void Profiler::init()
+{
+    for (Frame &frame : frames)
+        glGenQueries(PROFILER_MAX_SCOPES * 2, frame.queries);
+    scopes.reserve(PROFILER_MAX_SCOPES);
+    hasQueries = true;
+}
+
+void Profiler::destroy()
+{
+    if (hasQueries)
+    {
+        for (Frame &frame : frames)
+            glDeleteQueries(PROFILER_MAX_SCOPES * 2, frame.queries);
+        hasQueries = false;
+    }
+    if (log.is_open())
+        log.close();
+}
+
+// Per-frame log as CSV: frame,scope,cpu_ms,gpu_ms
+bool Profiler::openLog(const char *path)
+{
+    log.open(path);
+    if (!log)
+    {
+        std::cout << "ERROR::PROFILER::FAILED_TO_OPEN_LOG: " << path << std::endl;
+        return false;
+    }
+    log << "frame,scope,cpu_ms,gpu_ms\n";
+    return true;
+}
+
+void Profiler::beginFrame()
+{
+    isFrameActive = isEnabled && hasQueries;
+    if (!isFrameActive)
+        return;
+
+    // Results for this slot were issued PROFILER_FRAME_LATENCY frames ago
+    currentFrame = frameNumber % PROFILER_FRAME_LATENCY;
+    Frame &frame = frames[currentFrame];
+    resolveFrame(frame);
+
+    frame.scopeCount = 0;
+    frame.frameNumber = frameNumber;
+    depth = 0;
+
+    if (tracer.isEnabled() && frameNumber % TRACE_CALIBRATION_INTERVAL == 0)
+        tracer.calibrateGpuClock();
+}
+
+void Profiler::endFrame()
+{
+    if (!isFrameActive)
+        return;
+
+    frames[currentFrame].isPending = frames[currentFrame].scopeCount > 0;
+    isFrameActive = false;
+    frameNumber++;
+}
+
+// Scopes double as KHR_debug groups so captures and driver messages show the phase
+void Profiler::beginScope(const char *name)
+{
+    pushDebugGroup(name);
+    if (!isFrameActive || depth == PROFILER_MAX_DEPTH)
+        return;
+
+    Frame &frame = frames[currentFrame];
+    OpenScope &scope = openScopes[depth++];
+    scope.scopeId = findScope(name);
+    scope.record = -1;
+
+    // Out of queries this frame, keep the CPU timing only
+    if (frame.scopeCount < PROFILER_MAX_SCOPES)
+    {
+        scope.record = frame.scopeCount++;
+        frame.scopeIds[scope.record] = scope.scopeId;
+        glQueryCounter(frame.queries[scope.record * 2], GL_TIMESTAMP);
+    }
+    scope.cpuStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::endScope()
+{
+    popDebugGroup();
+    if (!isFrameActive || depth == 0)
+        return;
+
+    OpenScope &scope = openScopes[--depth];
+    std::chrono::steady_clock::time_point cpuEnd = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> cpuTime = cpuEnd - scope.cpuStart;
+    scopes[scope.scopeId].cpu.add(cpuTime.count());
+
+    uint64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(scope.cpuStart.time_since_epoch()).count();
+    uint64_t end = std::chrono::duration_cast<std::chrono::nanoseconds>(cpuEnd.time_since_epoch()).count();
+    tracer.addCpuEvent(scopes[scope.scopeId].name, start, end);
+    flightRecorder.addScope(scopes[scope.scopeId].name, start, end);
+
+    if (scope.record >= 0)
+    {
+        Frame &frame = frames[currentFrame];
+        glQueryCounter(frame.queries[scope.record * 2 + 1], GL_TIMESTAMP);
+        frame.cpuTimes[scope.record] = cpuTime.count();
+    }
+}
+
+const ProfilerScopeStats *Profiler::getScope(const char *name) const
+{
+    for (const ProfilerScopeStats &scope : scopes)
+        if (std::strcmp(scope.name, name) == 0)
+            return &scope;
+    return NULL;
+}
+
+const std::vector<ProfilerScopeStats> &Profiler::getScopes() const
+{
+    return scopes;
+}
+
+unsigned int Profiler::findScope(const char *name)
+{
+    for (unsigned int i = 0; i < scopes.size(); i++)
+        if (scopes[i].name == name || std::strcmp(scopes[i].name, name) == 0)
+            return i;
+
+    ProfilerScopeStats scope;
+    scope.name = name;
+    scopes.push_back(scope);
+    return scopes.size() - 1;
+}
+
+// Never waits on the GPU: a frame whose queries are still in flight is dropped
+void Profiler::resolveFrame(Frame &frame)
+{
+    if (!frame.isPending)
+        return;
+    frame.isPending = false;
+
+    // Nested scopes end out of order, so every end query has to be checked
+    for (unsigned int i = 0; i < frame.scopeCount; i++)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+    }
+
+    for (unsigned int i = 0; i < frame.scopeCount; i++)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        double gpuTime = (end - begin) / 1e6;
+
+        ProfilerScopeStats &scope = scopes[frame.scopeIds[i]];
+        scope.gpu.add(gpuTime);
+        tracer.addGpuEvent(scope.name, begin, end);
+        if (log.is_open())
+            log << frame.frameNumber << ',' << scope.name << ',' << frame.cpuTimes[i] << ',' << gpuTime << '\n';
+    }
+}
+
+// Bar per scope along the top edge, drawn with scissored clears so no shader is needed.
+// Half the screen width is one 60Hz frame (16.7ms), GPU bar on top and CPU bar beneath.
+void Profiler::drawOverlay(int width, int height) const
+{
+    if (!showOverlay)
+        return;
+
+    // Picked in sRGB, the clears are encoded back to sRGB on write
+    const float palette[][3] = {
+        { .90f, .30f, .25f }, { .25f, .70f, .35f }, { .25f, .45f, .90f }, { .95f, .75f, .20f },
+        { .70f, .35f, .85f }, { .20f, .80f, .80f }, { .95f, .50f, .15f }, { .60f, .60f, .60f }
+    };
+    const float msToPixels = (width * .5f) / 16.667f;
+    const int barHeight = 6;
+
+    glEnable(GL_SCISSOR_TEST);
+    for (unsigned int i = 0; i < scopes.size(); i++)
+    {
+        const float *color = palette[i % (sizeof(palette) / sizeof(palette[0]))];
+        int y = height - static_cast<int>(i + 1) * (barHeight * 2 + 4);
+
+        glScissor(0, y + barHeight, static_cast<int>(scopes[i].gpu.average() * msToPixels) + 1, barHeight);
+        glClearColor(srgbToLinear(color[0]), srgbToLinear(color[1]), srgbToLinear(color[2]), 1.f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glScissor(0, y, static_cast<int>(scopes[i].cpu.average() * msToPixels) + 1, barHeight);
+        glClearColor(srgbToLinear(color[0] * .5f), srgbToLinear(color[1] * .5f), srgbToLinear(color[2] * .5f), 1.f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+ProfileScope::ProfileScope(Profiler &profiler, const char *name) : profiler(profiler)
+{
+    profiler.beginScope(name);
+}
+
+ProfileScope::~ProfileScope()
+{
+    profiler.endScope();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "glad/glad.h"
+
+// Frames of timestamp queries kept in flight, results are read back this many frames later
+const unsigned int PROFILER_FRAME_LATENCY = 4;
+const unsigned int PROFILER_MAX_SCOPES = 32;
+const unsigned int PROFILER_MAX_DEPTH = 8;
+const unsigned int PROFILER_HISTORY = 64;
+
+// Fixed window moving average
+struct RollingAverage
+{
+    double samples[PROFILER_HISTORY] = {};
+    double sum = 0.0;
+    double last = 0.0;
+    unsigned int count = 0;
+    unsigned int head = 0;
+
+    void add(double value);
+    double average() const;
+};
+
+struct ProfilerScopeStats
+{
+    const char *name;
+    RollingAverage cpu;
+    RollingAverage gpu;
+};
+
+class Profiler
+{
+    public:
+
+    bool isEnabled = true;
+    bool showOverlay = false;
+
+    // Methods
+    void init();
+    void destroy();
+    bool openLog(const char *path);
+    void beginFrame();
+    void endFrame();
+    void beginScope(const char *name);
+    void endScope();
+    void drawOverlay(int width, int height) const;
+
+    // Rolling averages in milliseconds, NULL/0 for unknown scopes
+    const ProfilerScopeStats *getScope(const char *name) const;
+    const std::vector<ProfilerScopeStats> &getScopes() const;
+
+    private:
+
+    // Scopes recorded during one frame, with a begin/end timestamp query pair each
+    struct Frame
+    {
+        unsigned int queries[PROFILER_MAX_SCOPES * 2] = {};
+        unsigned int scopeIds[PROFILER_MAX_SCOPES] = {};
+        double cpuTimes[PROFILER_MAX_SCOPES] = {};
+        unsigned int scopeCount = 0;
+        unsigned long long frameNumber = 0;
+        bool isPending = false;
+    };
+
+    struct OpenScope
+    {
+        unsigned int scopeId;
+        int record;
+        std::chrono::steady_clock::time_point cpuStart;
+    };
+
+    Frame frames[PROFILER_FRAME_LATENCY];
+    OpenScope openScopes[PROFILER_MAX_DEPTH];
+    unsigned int depth = 0;
+    unsigned int currentFrame = 0;
+    unsigned long long frameNumber = 0;
+    bool isFrameActive = false;
+    bool hasQueries = false;
+    std::vector<ProfilerScopeStats> scopes;
+    std::ofstream log;
+
+    unsigned int findScope(const char *name);
+    void resolveFrame(Frame &frame);
+};
+
+// Times the enclosing block
+class ProfileScope
+{
+    public:
+
+    ProfileScope(Profiler &profiler, const char *name);
+    ~ProfileScope();
+
+    private:
+
+    Profiler &profiler;
+};
+#endif
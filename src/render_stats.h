@@ -0,0 +1,22 @@
+#pragma once
+
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// Per-frame driver traffic counters, reset at the start of every frame.
+// Filled by the GL instrumentation layer (gl_instrumentation.h), zero in builds without it.
+struct RenderStats
+{
+    unsigned int drawCalls = 0;
+    unsigned int programBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int vertexArrayBinds = 0;
+    unsigned int uniformCalls = 0;
+    unsigned int bufferUploads = 0;
+    unsigned long long bufferUploadBytes = 0;
+    unsigned int textureUploads = 0;
+    unsigned long long textureUploadBytes = 0;
+};
+
+extern RenderStats renderStats;
+#endif
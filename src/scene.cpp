@@ -0,0 +1,181 @@
+#include <cstddef>
+#include <vector>
+#include "scene.h"
+#include "texture.h"
+
+// Verticies of a cube
+const float CUBE_VERTICES[CUBE_VERTEX_COUNT * CUBE_VERTEX_STRIDE] = {
+    // Position          // Normal            // Texture Coordinates
+   -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+    0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
+    0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+    0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+   -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
+   -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+
+   -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+    0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
+    0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+    0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+   -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
+   -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+
+   -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+   -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+   -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+   -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+   -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+   -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+    0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+    0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+    0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+    0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+   -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+    0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
+    0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+    0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+   -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
+   -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+
+   -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
+    0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
+    0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+    0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+   -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
+   -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
+};
+
+// Cube positions
+const glm::vec3 CUBE_POSITIONS[CUBE_COUNT] = {
+    glm::vec3( 0.0f,  0.0f,  0.0f),
+    glm::vec3( 2.0f,  5.0f, -15.0f),
+    glm::vec3(-1.5f, -2.2f, -2.5f),
+    glm::vec3(-3.8f, -2.0f, -12.3f),
+    glm::vec3( 2.4f, -0.4f, -3.5f),
+    glm::vec3(-1.7f,  3.0f, -7.5f),
+    glm::vec3( 1.3f, -2.0f, -2.5f),
+    glm::vec3( 1.5f,  2.0f, -2.5f),
+    glm::vec3( 1.5f,  0.2f, -1.5f),
+    glm::vec3(-1.3f,  1.0f, -1.5f)
+};
+
+// Point light positions
+const glm::vec3 POINT_LIGHT_POSITIONS[POINT_LIGHT_COUNT] = {
+    glm::vec3(0.7f,  0.2f,  2.0f),
+    glm::vec3(2.3f, -3.3f, -4.0f),
+    glm::vec3(-4.0f,  2.0f, -12.0f),
+    glm::vec3(0.0f,  0.0f, -3.0f)
+};
+
+const glm::vec3 POINT_LIGHT_COLORS[POINT_LIGHT_COUNT] = {
+    linearColor(glm::vec3(1.f, 1.f, .2f)),
+    linearColor(glm::vec3(1.f, .15f, .0f)),
+    linearColor(glm::vec3(1.f, 1.f, 1.f)),
+    linearColor(glm::vec3(0.f, 0.2f, 1.f))
+};
+
+// Directional light
+const glm::vec3 DIR_LIGHT_DIRECTION = glm::vec3(-.2f, -1.f, -.3f);
+const glm::vec3 DIR_LIGHT_DIFFUSE = glm::vec3(.4f);
+const glm::vec3 DIR_LIGHT_SPECULAR = glm::vec3(.5f);
+
+glm::vec3 linearColor(const glm::vec3 &srgb)
+{
+    return glm::vec3(srgbToLinear(srgb.x), srgbToLinear(srgb.y), srgbToLinear(srgb.z));
+}
+
+// Per-cube model matrix, each cube is rotated 20 degrees more than the previous one.
+// Indices past CUBE_COUNT repeat the arrangement in layers further down -z.
+glm::mat4 cubeModelMatrix(unsigned int index)
+{
+    float angle = 20.f * index;
+    glm::vec3 layerOffset = glm::vec3(0.f, 0.f, -CUBE_LAYER_SPACING * (index / CUBE_COUNT));
+    glm::mat4 model = glm::mat4(1.f);
+    model = glm::translate(model, CUBE_POSITIONS[index % CUBE_COUNT] + layerOffset);
+    model = glm::rotate(model, glm::radians(angle), glm::vec3(1.f, .3f, .5f));
+    return model;
+}
+
+glm::mat4 lightModelMatrix(unsigned int index)
+{
+    glm::mat4 model = glm::mat4(1.f);
+    model = glm::translate(model, POINT_LIGHT_POSITIONS[index]);
+    model = glm::scale(model, glm::vec3(.5f));
+    return model;
+}
+
+glm::mat3 normalMatrix(const glm::mat4 &model)
+{
+    return glm::transpose(glm::inverse(model));
+}
+
+std::string lightingDefines(unsigned int pointLightCount, bool hasSpotLight)
+{
+    return "#define ACTIVE_POINT_LIGHTS " + std::to_string(pointLightCount) + "\n#define SPOT_LIGHT " + (hasSpotLight ? "1" : "0") + "\n";
+}
+
+// Upload the cube vertices and describe their layout, lit meshes also get normals and texture coordinates
+unsigned int createCubeVAO(unsigned int &VBO, bool isLit)
+{
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, CUBE_VERTEX_STRIDE * sizeof(float), (void*)0);   // Position
+    glEnableVertexAttribArray(0);
+    if (isLit)
+    {
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, CUBE_VERTEX_STRIDE * sizeof(float), (void*)(3 * sizeof(float))); // Normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, CUBE_VERTEX_STRIDE * sizeof(float), (void*)(6 * sizeof(float))); // Texture Coordinates
+        glEnableVertexAttribArray(2);
+    }
+
+    return VAO;
+}
+
+// Static per-cube transforms and materials (cycled by index), attached to the cube VAO with a divisor of 1
+unsigned int createCubeInstanceBuffer(unsigned int VAO, unsigned int count, unsigned int materialCount)
+{
+    std::vector<CubeInstance> instances(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        instances[i].model = cubeModelMatrix(i);
+        instances[i].normalModel = normalMatrix(instances[i].model);
+        instances[i].material = static_cast<float>(i % materialCount);
+    }
+
+    unsigned int instanceVBO;
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CubeInstance), instances.data(), GL_STATIC_DRAW);
+
+    // Matrices take one attribute location per column
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(offsetof(CubeInstance, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    for (unsigned int column = 0; column < 3; column++)
+    {
+        glVertexAttribPointer(7 + column, 3, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(offsetof(CubeInstance, normalModel) + column * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(7 + column);
+        glVertexAttribDivisor(7 + column, 1);
+    }
+    glVertexAttribPointer(10, 1, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, material));
+    glEnableVertexAttribArray(10);
+    glVertexAttribDivisor(10, 1);
+    glBindVertexArray(0);
+
+    return instanceVBO;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <string>
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Interleaved position (3), normal (3) and texture coordinates (2)
+const unsigned int CUBE_VERTEX_COUNT = 36;
+const unsigned int CUBE_VERTEX_STRIDE = 8;
+const unsigned int CUBE_COUNT = 10;
+const unsigned int POINT_LIGHT_COUNT = 4;    // Must match NR_POINT_LIGHTS in cube_frag.glsl
+const float CUBE_LAYER_SPACING = 15.f;       // Depth between repeats of the cube arrangement
+
+extern const float CUBE_VERTICES[CUBE_VERTEX_COUNT * CUBE_VERTEX_STRIDE];
+extern const glm::vec3 CUBE_POSITIONS[CUBE_COUNT];
+extern const glm::vec3 POINT_LIGHT_POSITIONS[POINT_LIGHT_COUNT];
+extern const glm::vec3 POINT_LIGHT_COLORS[POINT_LIGHT_COUNT];    // Linear, authored in sRGB
+
+// Static lights, evaluated per fragment or baked into the lightmap (see tools/lightmap_bake.cpp)
+extern const glm::vec3 DIR_LIGHT_DIRECTION;
+extern const glm::vec3 DIR_LIGHT_DIFFUSE;
+extern const glm::vec3 DIR_LIGHT_SPECULAR;
+const float LIGHT_CONSTANT = 1.f;            // Attenuation shared by the point lights and the flashlight
+const float LIGHT_LINEAR = .09f;
+const float LIGHT_QUADRATIC = .032f;
+
+// Colours are picked in sRGB but lit and blended in linear space, the framebuffer encodes back to sRGB on write
+glm::vec3 linearColor(const glm::vec3 &srgb);
+
+// Transforms
+glm::mat4 cubeModelMatrix(unsigned int index);
+glm::mat4 lightModelMatrix(unsigned int index);
+glm::mat3 normalMatrix(const glm::mat4 &model);
+
+// Per-instance attributes at locations 3-10 of the instanced cube shader
+struct CubeInstance
+{
+    glm::mat4 model;
+    glm::mat3 normalModel;
+    float material;    // Layer in the material arrays
+};
+
+// Shader defines that specialize cube_frag.glsl for one active light set, disabled lights are compiled out
+std::string lightingDefines(unsigned int pointLightCount, bool hasSpotLight);
+
+// Mesh building
+unsigned int createCubeVAO(unsigned int &VBO, bool isLit);
+unsigned int createCubeInstanceBuffer(unsigned int VAO, unsigned int count, unsigned int materialCount);
+#endif
@@ -14,61 +14,50 @@ class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+    // constructor generates the shader on the fly, defines ("#define X\n" lines) are inserted after #version
     // ------------------------------------------------------------------------
-    Shader(const char *vertexPath, const char *fragmentPath)
+    Shader(const char *vertexPath, const char *fragmentPath, const std::string &defines = "")
     {
         // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
+        compile(injectDefines(readSource(vertexPath), defines), injectDefines(readSource(fragmentPath), defines));
+    }
+    // build from sources that were already read, e.g. in a batch through AssetReader
+    // ------------------------------------------------------------------------
+    static Shader fromSource(const std::string &vertexSource, const std::string &fragmentSource, const std::string &defines = "")
+    {
+        Shader shader;
+        shader.compile(injectDefines(vertexSource, defines), injectDefines(fragmentSource, defines));
+        return shader;
+    }
+    // read a whole shader source file into a string in one read, empty on failure
+    // ------------------------------------------------------------------------
+    static std::string readSource(const char *path)
+    {
+        std::ifstream shaderFile(path, std::ios::binary | std::ios::ate);
+        std::string source;
+        if (shaderFile)
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            source.resize(static_cast<size_t>(shaderFile.tellg()));
+            shaderFile.seekg(0);
+            shaderFile.read(&source[0], static_cast<std::streamsize>(source.size()));
         }
-        catch (std::ifstream::failure &e)
+        if (!shaderFile)
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return std::string();
         }
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        return source;
+    }
+    // insert preprocessor lines after the #version directive, which has to stay first
+    // ------------------------------------------------------------------------
+    static std::string injectDefines(const std::string &source, const std::string &defines)
+    {
+        if (defines.empty())
+            return source;
+        size_t versionEnd = source.rfind("#version", 0) == 0 ? source.find('\n') : std::string::npos;
+        if (versionEnd == std::string::npos)
+            return defines + source;
+        return source.substr(0, versionEnd + 1) + defines + source.substr(versionEnd + 1);
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -98,6 +87,11 @@ public:
         glUniform3f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z);
     }
     // ------------------------------------------------------------------------
+    void setVec4(const std::string &name, glm::vec4 value) const
+    {
+        glUniform4f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z, value.w);
+    }
+    // ------------------------------------------------------------------------
     void setMat4(const std::string &name, glm::mat4 value) const
     {
         glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
@@ -109,6 +103,35 @@ public:
     }
 
 private:
+    Shader() : ID(0) {}
+    // compile and link both stages, the sources already carry their defines
+    // ------------------------------------------------------------------------
+    void compile(const std::string &vertexCode, const std::string &fragmentCode)
+    {
+        const char *vShaderCode = vertexCode.c_str();
+        const char *fShaderCode = fragmentCode.c_str();
+        // 2. compile shaders
+        unsigned int vertex, fragment;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, "FRAGMENT");
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(unsigned int shader, std::string type)
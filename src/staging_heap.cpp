@@ -0,0 +1,151 @@
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include "staging_heap.h"
+#include "glad/glad.h"
+#include "gl_debug.h"
+
+// Regions start on this boundary so every image offset keeps the alignment glTexSubImage2D rows want
+const size_t STAGING_ALIGNMENT = 256;
+
+// Requires a current GL context, false when persistent mapping (GL 4.4) is unavailable
+bool StagingHeap::init(size_t capacity)
+{
+    if (GLVersion.major < 4 || (GLVersion.major == 4 && GLVersion.minor < 4))
+        return false;
+
+    const GLbitfield FLAGS = GL_MAP_WRITE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, NULL, FLAGS);
+    mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, FLAGS));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!mapped)
+    {
+        std::cout << "ERROR::STAGING_HEAP::FAILED_TO_MAP" << std::endl;
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        return false;
+    }
+    labelObject(GL_BUFFER, buffer, "texture decode heap");
+
+    this->capacity = capacity;
+    freeRanges.clear();
+    usedRanges.clear();
+    freeRanges[0] = capacity;
+    usedBytes = peakBytes = 0;
+    return true;
+}
+
+// Waits for in-flight uploads, then unmaps and deletes the buffer
+void StagingHeap::destroy()
+{
+    for (RetiredRegion &region : retired)
+    {
+        glClientWaitSync(static_cast<GLsync>(region.fence), GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(static_cast<GLsync>(region.fence));
+    }
+    retired.clear();
+    if (buffer)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    mapped = nullptr;
+    capacity = 0;
+}
+
+// First fit, any thread. Returns nullptr when no free range is large enough so callers can fall back to heap memory.
+unsigned char *StagingHeap::allocate(size_t size, size_t &offset)
+{
+    size = (size + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::map<size_t, size_t>::iterator range = freeRanges.begin(); range != freeRanges.end(); range++)
+    {
+        if (range->second < size)
+            continue;
+        offset = range->first;
+        size_t remaining = range->second - size;
+        freeRanges.erase(range);
+        if (remaining)
+            freeRanges[offset + size] = remaining;
+        usedRanges[offset] = size;
+        usedBytes += size;
+        peakBytes = std::max(peakBytes, usedBytes);
+        return mapped + offset;
+    }
+    return nullptr;
+}
+
+// Returns a region the GPU never read, any thread
+void StagingHeap::free(size_t offset)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<size_t, size_t>::iterator used = usedRanges.find(offset);
+    if (used == usedRanges.end())
+        return;
+    size_t size = used->second;
+    usedRanges.erase(used);
+    usedBytes -= size;
+
+    // Merge with the neighbouring free ranges
+    std::map<size_t, size_t>::iterator next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin())
+    {
+        std::map<size_t, size_t>::iterator previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+    freeRanges[offset] = size;
+}
+
+// GL thread, call after the last command reading the region has been issued
+void StagingHeap::retire(size_t offset)
+{
+    retired.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), offset });
+}
+
+// GL thread, frees retired regions the GPU has finished with
+void StagingHeap::collect()
+{
+    std::vector<RetiredRegion>::iterator region = retired.begin();
+    while (region != retired.end())
+    {
+        GLenum status = glClientWaitSync(static_cast<GLsync>(region->fence), 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            region++;
+            continue;
+        }
+        glDeleteSync(static_cast<GLsync>(region->fence));
+        free(region->offset);
+        region = retired.erase(region);
+    }
+}
+
+bool StagingHeap::isAvailable() const
+{
+    return mapped != nullptr;
+}
+
+size_t StagingHeap::getCapacity() const
+{
+    return capacity;
+}
+
+size_t StagingHeap::getPeakBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return peakBytes;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef STAGING_HEAP_H
+#define STAGING_HEAP_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Persistently mapped pixel unpack buffer that worker threads decode into directly.
+// Regions are allocated from any thread and retired on the GL thread once the last upload reading them is issued,
+// a fence keeps them from being reused before the GPU has consumed them.
+class StagingHeap
+{
+    public:
+
+    unsigned int buffer = 0;
+
+    // Methods
+    bool init(size_t capacity);
+    void destroy();
+    unsigned char *allocate(size_t size, size_t &offset);
+    void free(size_t offset);
+    void retire(size_t offset);
+    void collect();
+    bool isAvailable() const;
+    size_t getCapacity() const;
+    size_t getPeakBytes() const;
+
+    private:
+
+    struct RetiredRegion
+    {
+        void *fence;
+        size_t offset;
+    };
+
+    unsigned char *mapped = nullptr;
+    size_t capacity = 0;
+    size_t usedBytes = 0;
+    size_t peakBytes = 0;
+    mutable std::mutex mutex;
+    std::map<size_t, size_t> freeRanges;    // Offset to size, coalesced on free
+    std::map<size_t, size_t> usedRanges;
+    std::vector<RetiredRegion> retired;     // GL thread only
+};
+#endif
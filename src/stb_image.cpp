@@ -1,2 +1,8 @@
+// Decode buffers go through the engine allocator, see image_allocator.h
+#include "image_allocator.h"
+#define STBI_MALLOC(size) imageMalloc(size)
+#define STBI_REALLOC(block, size) imageRealloc(block, size)
+#define STBI_FREE(block) imageFree(block)
+
 #define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
\ No newline at end of file
+#include "stb_image.h"
@@ -0,0 +1,256 @@
+#include "texture.h"
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "stb_image.h"
+#include "image_allocator.h"
+#include "gl_debug.h"
+
+// Load texture
+unsigned int loadTexture(char const* path, TextureUsage usage)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    // Decoded as RGBA, the import stage picks the smallest format that holds it
+    int width, height, nrComponents;
+    unsigned char *data = decodeImageFile(path, &width, &height, &nrComponents, 4);
+    if (data)
+    {
+        TextureImport import = importTexture(data, width, height, usage);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        labelObject(GL_TEXTURE, textureID, path);
+        allocateTexture(import, width, height, textureLevelCount(width, height));
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, import.format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "ERROR::Failed to load texture at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
+
+// RGB sources arrive expanded to RGBA, which uploads without per-row conversion. Colour maps keep all four
+// channels since core GL has no single-channel sRGB format, data maps whose texels are all grey and opaque drop to one.
+TextureImport importTexture(unsigned char *pixels, int width, int height, TextureUsage usage)
+{
+    TextureImport import;
+    import.internalFormat = usage == TEXTURE_USAGE_COLOR ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    import.format = GL_RGBA;
+    import.components = 4;
+    if (usage == TEXTURE_USAGE_COLOR)
+        return import;
+
+    size_t texelCount = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < texelCount; i++)
+    {
+        const unsigned char *texel = pixels + i * 4;
+        if (texel[0] != texel[1] || texel[0] != texel[2] || texel[3] != 255)
+            return import;
+    }
+    for (size_t i = 0; i < texelCount; i++)
+        pixels[i] = pixels[i * 4];
+    import.internalFormat = GL_R8;
+    import.format = GL_RED;
+    import.components = 1;
+    return import;
+}
+
+// Allocates every level of the bound 2D texture, immutable when the context has glTexStorage2D
+void allocateTexture(const TextureImport &import, int width, int height, int levelCount)
+{
+    if (hasTextureStorage())
+        glTexStorage2D(GL_TEXTURE_2D, levelCount, import.internalFormat, width, height);
+    else
+    {
+        for (int level = 0; level < levelCount; level++)
+            glTexImage2D(GL_TEXTURE_2D, level, import.internalFormat, std::max(width >> level, 1), std::max(height >> level, 1), 0,
+                         import.format, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    }
+    setTextureSwizzle(import.internalFormat);
+}
+
+float srgbToLinear(float value)
+{
+    return value <= .04045f ? value / 12.92f : std::pow((value + .055f) / 1.055f, 2.4f);
+}
+
+unsigned char linearToSRGB(float value)
+{
+    float c = value <= .0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - .055f;
+    return static_cast<unsigned char>(std::lround(std::min(std::max(c, 0.f), 1.f) * 255.f));
+}
+
+// Box filter, odd sizes fold the last row/column into the final destination texel
+std::vector<unsigned char> downsampleLevel(const unsigned char *pixels, int width, int height, int components, bool isSRGB)
+{
+    static const std::vector<float> SRGB_TO_LINEAR = []() {
+        std::vector<float> table(256);
+        for (int i = 0; i < 256; i++)
+            table[i] = srgbToLinear(i / 255.f);
+        return table;
+    }();
+
+    int levelWidth = std::max(width / 2, 1);
+    int levelHeight = std::max(height / 2, 1);
+    std::vector<unsigned char> level(static_cast<size_t>(levelWidth) * levelHeight * components);
+    for (int y = 0; y < levelHeight; y++)
+        for (int x = 0; x < levelWidth; x++)
+        {
+            int x0 = x * 2, x1 = (x == levelWidth - 1) ? width : std::min(x0 + 2, width);
+            int y0 = y * 2, y1 = (y == levelHeight - 1) ? height : std::min(y0 + 2, height);
+            float count = static_cast<float>((x1 - x0) * (y1 - y0));
+            for (int c = 0; c < components; c++)
+            {
+                bool isLinear = isSRGB && c < 3;
+                float sum = 0.f;
+                for (int sy = y0; sy < y1; sy++)
+                    for (int sx = x0; sx < x1; sx++)
+                    {
+                        unsigned char value = pixels[(static_cast<size_t>(sy) * width + sx) * components + c];
+                        sum += isLinear ? SRGB_TO_LINEAR[value] : value / 255.f;
+                    }
+                float average = sum / count;
+                level[(static_cast<size_t>(y) * levelWidth + x) * components + c] =
+                    isLinear ? linearToSRGB(average) : static_cast<unsigned char>(std::lround(average * 255.f));
+            }
+        }
+    return level;
+}
+
+// Single channel formats are sampled as grey so shaders read them like the RGB maps they replace
+void setTextureSwizzle(unsigned int internalFormat)
+{
+    if (internalFormat != GL_R8 && internalFormat != GL_COMPRESSED_RED_RGTC1)
+        return;
+    const GLint GREY_SWIZZLE[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, GREY_SWIZZLE);
+}
+
+// Full chain down to 1x1
+int textureLevelCount(int width, int height)
+{
+    int levelCount = 1;
+    while ((width >> levelCount) > 0 || (height >> levelCount) > 0)
+        levelCount++;
+    return levelCount;
+}
+
+// Requires a current GL context
+bool hasTextureStorage()
+{
+    return GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2);
+}
+
+const char *textureFormatName(unsigned int internalFormat)
+{
+    switch (internalFormat)
+    {
+        case GL_R8:
+            return "R8";
+        case GL_RG8:
+            return "RG8";
+        case GL_RGB8:
+            return "RGB8";
+        case GL_RGBA8:
+            return "RGBA8";
+        case GL_SRGB8_ALPHA8:
+            return "SRGB8_ALPHA8";
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            return "BC1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return "BC3";
+        case GL_COMPRESSED_RED_RGTC1:
+            return "BC4";
+        case GL_COMPRESSED_RG_RGTC2:
+            return "BC5";
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return "BC7";
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+            return "ETC2";
+        default:
+            return "unknown";
+    }
+}
+
+// Requires a current GL context
+bool isCompressedFormatSupported(unsigned int internalFormat)
+{
+    bool isGL42 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2);
+    bool isGL43 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+    switch (internalFormat)
+    {
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_RG_RGTC2:
+            return true;
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return hasGLExtension("GL_EXT_texture_compression_s3tc");
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return hasGLExtension("GL_EXT_texture_compression_s3tc") &&
+                   (hasGLExtension("GL_EXT_texture_sRGB") || hasGLExtension("GL_EXT_texture_compression_s3tc_srgb"));
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return isGL42 || hasGLExtension("GL_ARB_texture_compression_bptc");
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+            return isGL43 || hasGLExtension("GL_ARB_ES3_compatibility");
+        default:
+            return false;
+    }
+}
+
+// Uploads one precomputed level into the bound texture, data may be an offset into a bound unpack buffer
+void uploadCompressedLevel(const KTX2Image &image, unsigned int level, const void *data)
+{
+    const KTX2Level &info = image.levels[level];
+    if (level == 0)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        setTextureSwizzle(ktx2InternalFormat(image.vkFormat));
+    }
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, ktx2InternalFormat(image.vkFormat), info.width, info.height, 0,
+                           static_cast<GLsizei>(info.size), data);
+}
+
+// Load a cooked texture, mips come from the file instead of glGenerateMipmap
+unsigned int loadCompressedTexture(char const *path)
+{
+    KTX2Image image;
+    if (!readKTX2(path, image) || !isCompressedFormatSupported(ktx2InternalFormat(image.vkFormat)))
+        return 0;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    labelObject(GL_TEXTURE, textureID, path);
+    for (unsigned int level = 0; level < image.levels.size(); level++)
+        uploadCompressedLevel(image, level, image.data.data() + image.levels[level].offset);
+    return textureID;
+}
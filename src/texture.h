@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <vector>
+#include "ktx2.h"
+
+// How sampled values are interpreted, colour maps are sRGB encoded and decoded to linear by the sampler
+enum TextureUsage
+{
+    TEXTURE_USAGE_COLOR,
+    TEXTURE_USAGE_DATA
+};
+
+// Storage chosen for decoded pixels by importTexture
+struct TextureImport
+{
+    unsigned int internalFormat = 0;    // Sized, as glTexStorage2D requires
+    unsigned int format = 0;            // Pixel transfer format
+    int components = 0;                 // Bytes per texel after repacking
+};
+
+// Loads an image from disk into a mipmapped, repeating 2D texture
+unsigned int loadTexture(char const *path, TextureUsage usage = TEXTURE_USAGE_COLOR);
+
+// Import stage for RGBA8 pixels: colour maps become GL_SRGB8_ALPHA8, grey opaque data maps are repacked in place to GL_R8
+TextureImport importTexture(unsigned char *pixels, int width, int height, TextureUsage usage);
+void allocateTexture(const TextureImport &import, int width, int height, int levelCount);
+
+// sRGB transfer function on normalized values, encoded back to a byte for 8-bit storage
+float srgbToLinear(float value);
+unsigned char linearToSRGB(float value);
+
+// Next mip level of tightly packed 8-bit texels, max(width / 2, 1) by max(height / 2, 1).
+// With isSRGB the first three channels are averaged in linear space to match what the sampler filters.
+std::vector<unsigned char> downsampleLevel(const unsigned char *pixels, int width, int height, int components, bool isSRGB);
+void setTextureSwizzle(unsigned int internalFormat);
+int textureLevelCount(int width, int height);
+bool hasTextureStorage();
+const char *textureFormatName(unsigned int internalFormat);
+
+// Cooked KTX2 textures, 0 when the file is missing or its format is unsupported so callers can fall back to loadTexture
+unsigned int loadCompressedTexture(char const *path);
+bool isCompressedFormatSupported(unsigned int internalFormat);
+void uploadCompressedLevel(const KTX2Image &image, unsigned int level, const void *data);
+#endif
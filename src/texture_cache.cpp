@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "texture_cache.h"
+
+const char TEXTURE_CACHE_MAGIC[8] = { 'L', 'O', 'G', 'L', 'T', 'E', 'X', '\n' };
+
+// Written in native byte order, the cache is local to the machine that built it
+struct TextureCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t components;
+    uint64_t key;
+    int32_t width;
+    int32_t height;
+    uint32_t internalFormat;
+    uint32_t format;
+    uint64_t pixelBytes;
+};
+
+// Creates the directory when missing, the cache stays disabled if that fails
+bool TextureCache::init(const char *directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cout << "ERROR::TEXTURE_CACHE::FAILED_TO_CREATE_DIRECTORY: " << directory << std::endl;
+        this->directory.clear();
+        return false;
+    }
+    this->directory = directory;
+    return true;
+}
+
+bool TextureCache::isEnabled() const
+{
+    return !directory.empty();
+}
+
+std::string TextureCache::entryPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.tex", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
+
+// Maps the entry for key, false when it is missing, stale or truncated
+bool TextureCache::find(uint64_t key, TextureCacheEntry &entry) const
+{
+    if (!isEnabled())
+        return false;
+    int file = open(entryPath(key).c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(file, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(TextureCacheHeader))
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    const TextureCacheHeader *header = static_cast<const TextureCacheHeader*>(mapping);
+    size_t pixelBytes = static_cast<size_t>(header->width) * header->height * header->components;
+    if (std::memcmp(header->magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) != 0 || header->version != TEXTURE_CACHE_VERSION ||
+        header->key != key || header->width <= 0 || header->height <= 0 || header->pixelBytes != pixelBytes ||
+        static_cast<size_t>(status.st_size) < sizeof(TextureCacheHeader) + pixelBytes)
+    {
+        munmap(mapping, status.st_size);
+        return false;
+    }
+
+    entry.mapping = mapping;
+    entry.mappingBytes = status.st_size;
+    entry.pixels = static_cast<const unsigned char*>(mapping) + sizeof(TextureCacheHeader);
+    entry.width = header->width;
+    entry.height = header->height;
+    entry.import.internalFormat = header->internalFormat;
+    entry.import.format = header->format;
+    entry.import.components = static_cast<int>(header->components);
+    return true;
+}
+
+// Writes to a temporary file first, so a crash or a second writer never leaves a torn entry behind
+bool TextureCache::store(uint64_t key, const unsigned char *pixels, int width, int height, const TextureImport &import) const
+{
+    if (!isEnabled())
+        return false;
+
+    TextureCacheHeader header;
+    std::memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC));
+    header.version = TEXTURE_CACHE_VERSION;
+    header.components = static_cast<uint32_t>(import.components);
+    header.key = key;
+    header.width = width;
+    header.height = height;
+    header.internalFormat = import.internalFormat;
+    header.format = import.format;
+    header.pixelBytes = static_cast<uint64_t>(width) * height * import.components;
+
+    std::string path = entryPath(key);
+    std::string temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(header.pixelBytes));
+        if (!file)
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::FAILED_TO_WRITE: " << temporaryPath << std::endl;
+            file.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void TextureCache::release(TextureCacheEntry &entry)
+{
+    if (entry.mapping)
+        munmap(entry.mapping, entry.mappingBytes);
+    entry = TextureCacheEntry();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "texture.h"
+
+// Bump when importTexture or the file layout changes, older entries are then ignored and rewritten
+const uint32_t TEXTURE_CACHE_VERSION = 1;
+
+// Imported pixels of one cache file, mapped read-only until release
+struct TextureCacheEntry
+{
+    const unsigned char *pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    TextureImport import;
+
+    void *mapping = nullptr;
+    size_t mappingBytes = 0;
+};
+
+// Decoded and imported level 0 images on disk, one raw file per key so warm runs map them instead of decoding.
+// Keys hash the source bytes together with the import settings, a changed source or usage simply misses.
+// Every method is safe to call from the decode workers.
+class TextureCache
+{
+    public:
+
+    // Methods
+    bool init(const char *directory);
+    bool isEnabled() const;
+    bool find(uint64_t key, TextureCacheEntry &entry) const;
+    bool store(uint64_t key, const unsigned char *pixels, int width, int height, const TextureImport &import) const;
+    static void release(TextureCacheEntry &entry);
+
+    private:
+
+    std::string directory;
+
+    std::string entryPath(uint64_t key) const;
+};
+#endif
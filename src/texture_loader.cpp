@@ -0,0 +1,591 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include "texture_loader.h"
+#include "texture.h"
+#include "stb_image.h"
+#include "gl_debug.h"
+#include "trace.h"
+
+static bool readFile(const std::string &path, std::vector<unsigned char> &bytes)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Bytes of a full mip chain at the decoded size
+static size_t mipChainBytes(int width, int height, int components)
+{
+    size_t bytes = 0;
+    for (int level = 0; ; level++)
+    {
+        int levelWidth = std::max(width >> level, 1), levelHeight = std::max(height >> level, 1);
+        bytes += static_cast<size_t>(levelWidth) * levelHeight * components;
+        if (levelWidth == 1 && levelHeight == 1)
+            return bytes;
+    }
+}
+
+// Starts the decode workers and creates the placeholder, requires a current GL context
+void AsyncTextureLoader::init(unsigned int workerCount, const char *cacheDirectory, AssetReader *reader, const AssetPack *pack)
+{
+    if (workerCount == 0)
+        workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    // Mid grey placeholder, bound in place of textures still loading
+    const unsigned char PLACEHOLDER_PIXEL[4] = { 128, 128, 128, 255 };
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D, placeholder);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_PIXEL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    labelObject(GL_TEXTURE, placeholder, "placeholder texture");
+
+    glGenBuffers(1, &stagingBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STAGING_BYTES, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    labelObject(GL_BUFFER, stagingBuffer, "texture staging buffer");
+
+    // Workers only read this, so cooked files in formats the driver lacks fall back to decoding
+    const unsigned int VK_FORMATS[] = {
+        VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGB_SRGB_BLOCK, VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK,
+        VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC7_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK,
+        VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+    };
+    supportedFormats.clear();
+    for (unsigned int vkFormat : VK_FORMATS)
+        if (isCompressedFormatSupported(ktx2InternalFormat(vkFormat)))
+            supportedFormats.push_back(ktx2InternalFormat(vkFormat));
+
+    // Without persistent mapping every image takes the staging buffer copy
+    decodeHeap.init(TEXTURE_DECODE_HEAP_BYTES);
+    if (cacheDirectory)
+        decodeCache.init(cacheDirectory);
+    assetReader = reader;
+    assetPack = pack && pack->isOpen() ? pack : nullptr;
+
+    isStopping = false;
+    for (unsigned int i = 0; i < workerCount; i++)
+        workers.emplace_back(&AsyncTextureLoader::decodeLoop, this);
+}
+
+// Joins the workers and deletes every texture the loader created
+void AsyncTextureLoader::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+
+    // Reads for textures no worker reached still write into their buffers
+    if (assetReader)
+        assetReader->waitAll();
+
+    for (AsyncTexture &texture : textures)
+    {
+        freePixels(texture);
+        if (texture.texture)
+            glDeleteTextures(1, &texture.texture);
+    }
+    textures.clear();
+    decodeQueue.clear();
+    uploadQueue.clear();
+    pathIndex.clear();
+    hashIndex.clear();
+    pendingCount = residentCount = 0;
+    residentBytes = 0;
+    glDeleteTextures(1, &placeholder);
+    glDeleteBuffers(1, &stagingBuffer);
+    placeholder = stagingBuffer = 0;
+    decodeHeap.destroy();
+}
+
+std::string AsyncTextureLoader::normalizePath(const char *path)
+{
+    std::error_code error;
+    std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+    return error ? std::filesystem::path(path).lexically_normal().string() : normalized.string();
+}
+
+// Queues a texture for decoding, the returned handle resolves to the placeholder until it is uploaded.
+// Requesting a path that is already loaded or loading adds a reference to the existing handle instead.
+unsigned int AsyncTextureLoader::request(const char *path, const char *cookedPath, TextureUsage usage)
+{
+    std::string key = normalizePath(path) + '|' + (cookedPath ? normalizePath(cookedPath) : std::string()) + '|' + std::to_string(usage);
+    std::unordered_map<std::string, unsigned int>::iterator existing = pathIndex.find(key);
+    if (existing != pathIndex.end())
+    {
+        acquire(existing->second);
+        pathHits++;
+        return existing->second;
+    }
+
+    AsyncTexture texture;
+    texture.path = path;
+    texture.cookedPath = cookedPath ? cookedPath : "";
+    texture.usage = usage;
+    texture.key = key;
+    texture.refCount = 1;
+    glGenTextures(1, &texture.texture);
+
+    // Start reading loose files now, alongside every other queued asset, instead of when a worker gets to the texture.
+    // Packed files are already mapped.
+    AssetSpan span;
+    if (assetReader)
+    {
+        if (!assetPack || !assetPack->find(path, span))
+            texture.sourceRead = assetReader->read(path, texture.sourceBytes);
+        if (cookedPath && (!assetPack || !assetPack->find(cookedPath, span)))
+            texture.cookedRead = assetReader->read(cookedPath, texture.cookedBytes);
+        assetReader->submit();
+    }
+
+    unsigned int handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        handle = static_cast<unsigned int>(textures.size());
+        textures.push_back(std::move(texture));
+        decodeQueue.push_back(handle);
+    }
+    pathIndex[key] = handle;
+    pendingCount++;
+    condition.notify_one();
+    return handle;
+}
+
+// Uploads decoded textures until the frame budget is spent, call once per frame on the GL thread
+void AsyncTextureLoader::update(double budgetMs)
+{
+    decodeHeap.collect();
+    if (pendingCount == 0)
+        return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < budgetMs)
+    {
+        unsigned int handle;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (uploadQueue.empty())
+                return;
+            handle = uploadQueue.front();
+        }
+
+        // Duplicates share the texture they alias, released requests are dropped without uploading
+        AsyncTexture &texture = textures[handle];
+        bool isDone = true;
+        if (texture.aliasOf >= 0 && texture.texture)
+        {
+            glDeleteTextures(1, &texture.texture);
+            texture.texture = 0;
+            texture.isReady = true;
+        }
+        else if (!texture.isReleased && !texture.isFailed)
+        {
+            std::chrono::steady_clock::time_point sliceStart = std::chrono::steady_clock::now();
+            isDone = texture.isCompressed ? uploadCompressedSlice(texture) : uploadSlice(texture);
+            texture.uploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sliceStart).count();
+        }
+        if (isDone)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                uploadQueue.pop_front();
+            }
+            pendingCount--;
+            texture.isSettled = true;
+            if (texture.isReady && texture.aliasOf < 0)
+            {
+                residentBytes += texture.residentBytes;
+                residentCount++;
+            }
+            if (texture.isReleased)
+                freeTexture(texture);
+        }
+    }
+}
+
+// Blocks until every requested texture is resident
+void AsyncTextureLoader::finish()
+{
+    while (!isIdle())
+    {
+        update(1000.0);
+        std::this_thread::yield();
+    }
+}
+
+bool AsyncTextureLoader::isIdle()
+{
+    return pendingCount == 0;
+}
+
+unsigned int AsyncTextureLoader::getTexture(unsigned int handle) const
+{
+    if (handle >= textures.size() || !textures[handle].isReady || textures[handle].isReleased)
+        return placeholder;
+    if (textures[handle].aliasOf >= 0)
+        return getTexture(textures[handle].aliasOf);
+    return textures[handle].texture;
+}
+
+// Reference counts are shared with workers that alias duplicates
+void AsyncTextureLoader::acquire(unsigned int handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle < textures.size() && textures[handle].refCount > 0)
+        textures[handle].refCount++;
+}
+
+// Drops a reference, the GL texture is deleted with the last one
+void AsyncTextureLoader::release(unsigned int handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (handle >= textures.size() || textures[handle].refCount == 0 || --textures[handle].refCount > 0)
+            return;
+
+        textures[handle].isReleased = true;
+        std::unordered_map<uint64_t, unsigned int>::iterator entry = hashIndex.find(textures[handle].contentHash);
+        if (entry != hashIndex.end() && entry->second == handle)
+            hashIndex.erase(entry);
+    }
+    AsyncTexture &texture = textures[handle];
+    pathIndex.erase(texture.key);
+
+    // Textures still in the queues are freed by update once the workers are done with them
+    if (texture.isSettled)
+        freeTexture(texture);
+}
+
+void AsyncTextureLoader::freeTexture(AsyncTexture &texture)
+{
+    freePixels(texture);
+    texture.compressed = KTX2Image();
+    if (texture.texture)
+    {
+        glDeleteTextures(1, &texture.texture);
+        texture.texture = 0;
+    }
+    if (texture.isReady && texture.aliasOf < 0)
+    {
+        residentBytes -= texture.residentBytes;
+        residentCount--;
+    }
+    texture.isReady = false;
+    if (texture.aliasOf >= 0)
+    {
+        unsigned int original = static_cast<unsigned int>(texture.aliasOf);
+        texture.aliasOf = -1;
+        release(original);
+    }
+}
+
+// Staged regions may still be read by issued uploads, so they go back to the heap behind a fence.
+// Cached pixels were copied into the staging buffer, their mapping can go right away.
+void AsyncTextureLoader::freePixels(AsyncTexture &texture)
+{
+    TextureCache::release(texture.cached);
+    if (texture.pixels && texture.isStaged)
+        decodeHeap.retire(texture.stagingRegion);
+    else
+        stbi_image_free(texture.pixels);
+    texture.pixels = nullptr;
+}
+
+size_t AsyncTextureLoader::getResidentBytes() const
+{
+    return residentBytes;
+}
+
+unsigned int AsyncTextureLoader::getResidentCount() const
+{
+    return residentCount;
+}
+
+void AsyncTextureLoader::printStats() const
+{
+    std::cout << "Textures: " << residentCount << " resident, " << std::fixed << std::setprecision(2)
+              << residentBytes / (1024.0 * 1024.0) << " MiB, " << pathHits << " path hits, "
+              << contentHits << " content hits" << std::endl;
+    if (decodeHeap.isAvailable())
+        std::cout << "Decode heap: " << decodeHeap.getPeakBytes() / (1024.0 * 1024.0) << " MiB peak of "
+                  << decodeHeap.getCapacity() / (1024.0 * 1024.0) << " MiB" << std::endl;
+    if (decodeCache.isEnabled())
+        std::cout << "Decode cache: " << cacheHits << " hits, " << cacheMisses << " misses" << std::endl;
+
+    // Per texture memory and upload time, including mips
+    for (const AsyncTexture &texture : textures)
+        if (texture.isReady && texture.aliasOf < 0 && !texture.isReleased)
+            std::cout << "    " << texture.path << ": " << texture.width << "x" << texture.height << " "
+                      << textureFormatName(texture.import.internalFormat) << ", " << texture.residentBytes / 1024.0 << " KiB, "
+                      << texture.uploadMs << " ms upload, " << texture.decodeStats.allocations << " decode allocations, "
+                      << texture.decodeStats.peakBytes / 1024.0 << " KiB decode peak"
+                      << (texture.isStaged ? ", decoded in place" : "") << (texture.isCached ? ", from cache" : "") << std::endl;
+}
+
+void AsyncTextureLoader::decodeLoop()
+{
+    while (true)
+    {
+        unsigned int handle;
+        std::string path, cookedPath;
+        TextureUsage usage;
+        unsigned int sourceRead, cookedRead;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return isStopping || !decodeQueue.empty(); });
+            if (isStopping)
+                return;
+            handle = decodeQueue.front();
+            decodeQueue.pop_front();
+            path = textures[handle].path;
+            cookedPath = textures[handle].cookedPath;
+            usage = textures[handle].usage;
+            sourceRead = textures[handle].sourceRead;
+            cookedRead = textures[handle].cookedRead;
+        }
+
+        // Prefer the cooked file when the driver can sample its format. Files outside the pack were read with the request.
+        KTX2Image compressed;
+        bool hasCooked = false;
+        if (cookedRead != ASSET_READ_NONE)
+        {
+            bool hasRead = assetReader->wait(cookedRead);
+            std::lock_guard<std::mutex> lock(mutex);
+            compressed.data = std::move(textures[handle].cookedBytes);
+            hasCooked = hasRead && parseKTX2(cookedPath.c_str(), compressed);
+        }
+        else if (!cookedPath.empty())
+            hasCooked = readAssetKTX2(assetPack, cookedPath.c_str(), compressed);
+        bool isCompressed = hasCooked &&
+            std::find(supportedFormats.begin(), supportedFormats.end(), ktx2InternalFormat(compressed.vkFormat)) != supportedFormats.end();
+
+        // Packed sources are decoded straight from the mapping and carry their hash
+        std::vector<unsigned char> bytes;
+        AssetSpan source;
+        bool hasSource = false;
+        if (sourceRead != ASSET_READ_NONE)
+        {
+            hasSource = assetReader->wait(sourceRead);
+            std::lock_guard<std::mutex> lock(mutex);
+            bytes = std::move(textures[handle].sourceBytes);
+        }
+        else if (!isCompressed)
+            hasSource = (assetPack && assetPack->find(path.c_str(), source)) || readFile(path, bytes);
+        if (!source.data && hasSource && !isCompressed)
+        {
+            source.data = bytes.data();
+            source.size = bytes.size();
+            source.hash = hashAssetBytes(bytes.data(), bytes.size());
+        }
+        bool hasBytes = isCompressed || hasSource;
+        uint64_t contentHash = isCompressed ? hashAssetBytes(compressed.data.data(), compressed.data.size()) : source.hash;
+
+        // Identical content already requested under another path, share its texture. Usage decides the format, so it is part of the hash.
+        if (hasBytes)
+            contentHash = contentHash * 1099511628211ull + static_cast<uint64_t>(usage) + 1;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            AsyncTexture &texture = textures[handle];
+            texture.contentHash = contentHash;
+            std::unordered_map<uint64_t, unsigned int>::iterator original = hashIndex.find(contentHash);
+            if (hasBytes && original != hashIndex.end() && !textures[original->second].isReleased)
+            {
+                texture.aliasOf = static_cast<int>(original->second);
+                textures[original->second].refCount++;
+                contentHits++;
+                uploadQueue.push_back(handle);
+                continue;
+            }
+            if (hasBytes)
+                hashIndex[contentHash] = handle;
+            if (isCompressed)
+            {
+                texture.residentBytes = 0;
+                for (const KTX2Level &level : compressed.levels)
+                    texture.residentBytes += level.size;
+                texture.width = compressed.width;
+                texture.height = compressed.height;
+                texture.import.internalFormat = ktx2InternalFormat(compressed.vkFormat);
+                texture.compressed = std::move(compressed);
+                texture.isCompressed = true;
+                uploadQueue.push_back(handle);
+                continue;
+            }
+        }
+
+        // Imported earlier from the same bytes with the same usage, nothing to decode
+        TextureCacheEntry cached;
+        if (hasBytes && decodeCache.find(contentHash, cached))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            AsyncTexture &texture = textures[handle];
+            texture.cached = cached;
+            texture.isCached = true;
+            texture.width = cached.width;
+            texture.height = cached.height;
+            texture.import = cached.import;
+            texture.residentBytes = mipChainBytes(cached.width, cached.height, cached.import.components);
+            cacheHits++;
+            uploadQueue.push_back(handle);
+            continue;
+        }
+
+        int width = 0, height = 0, nrComponents = 0;
+        unsigned char *data = nullptr;
+        TextureImport import;
+        ImageDecodeStats decodeStats;
+        size_t stagingRegion = 0;
+        bool isStaged = false;
+        if (hasBytes)
+        {
+            TraceScope scope("texture decode");
+
+            // Straight into the mapped heap when it has room, the upload then reads the pixels where they were decoded
+            size_t regionBytes = decodeHeap.isAvailable() ? imageDecodeBytes(source.data, source.size, 4) + IMAGE_BLOCK_HEADER_BYTES : 0;
+            unsigned char *region = regionBytes > IMAGE_BLOCK_HEADER_BYTES ? decodeHeap.allocate(regionBytes, stagingRegion) : nullptr;
+            if (region)
+            {
+                data = decodeImageInto(source.data, source.size, region, regionBytes, &width, &height, &nrComponents, 4, &decodeStats);
+                isStaged = data != nullptr;
+                if (!isStaged)
+                    decodeHeap.free(stagingRegion);
+            }
+            else
+                data = decodeImage(source.data, source.size, &width, &height, &nrComponents, 4, &decodeStats);
+        }
+        if (data)
+        {
+            TraceScope scope("texture import");
+            import = importTexture(data, width, height, usage);
+        }
+        else
+            std::cout << "ERROR::Failed to load texture at path: " << path << std::endl;
+        if (data && decodeCache.isEnabled())
+        {
+            TraceScope scope("texture cache write");
+            decodeCache.store(contentHash, data, width, height, import);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (data && decodeCache.isEnabled())
+            cacheMisses++;
+        AsyncTexture &texture = textures[handle];
+        texture.pixels = data;
+        texture.isStaged = isStaged;
+        texture.stagingRegion = stagingRegion;
+        texture.width = width;
+        texture.height = height;
+        texture.import = import;
+        texture.decodeStats = decodeStats;
+        texture.residentBytes = data ? mipChainBytes(width, height, import.components) : 0;
+        texture.isFailed = data == nullptr;
+        uploadQueue.push_back(handle);
+    }
+}
+
+// Streams the next rows through the staging buffer, returns true once the texture is complete
+bool AsyncTextureLoader::uploadSlice(AsyncTexture &texture)
+{
+    GLenum format = texture.import.format;
+    glBindTexture(GL_TEXTURE_2D, texture.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (texture.uploadedRows == 0)
+    {
+        // The name only becomes a texture object once bound, so it is labelled here rather than in request()
+        labelObject(GL_TEXTURE, texture.texture, texture.path);
+        allocateTexture(texture.import, texture.width, texture.height, textureLevelCount(texture.width, texture.height));
+    }
+
+    size_t rowBytes = static_cast<size_t>(texture.width) * texture.import.components;
+    int rows = std::min(texture.height - texture.uploadedRows, std::max(static_cast<int>(TEXTURE_STAGING_BYTES / rowBytes), 1));
+    size_t sliceBytes = rowBytes * rows;
+    if (texture.isStaged)
+    {
+        // Staged images upload from where they were decoded, nothing is copied
+        size_t offset = texture.stagingRegion + IMAGE_BLOCK_HEADER_BYTES + rowBytes * texture.uploadedRows;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, decodeHeap.buffer);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, texture.uploadedRows, texture.width, rows, format, GL_UNSIGNED_BYTE, (void*)offset);
+    }
+    else
+    {
+        // Orphan the staging buffer so the copy never waits on the previous slice
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, std::max<size_t>(sliceBytes, TEXTURE_STAGING_BYTES), NULL, GL_STREAM_DRAW);
+        void *staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, sliceBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!staging)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            std::cout << "ERROR::TEXTURE_LOADER::FAILED_TO_MAP_STAGING_BUFFER: " << texture.path << std::endl;
+            texture.isFailed = true;
+            return true;
+        }
+        const unsigned char *pixels = texture.cached.pixels ? texture.cached.pixels : texture.pixels;
+        std::memcpy(staging, pixels + rowBytes * texture.uploadedRows, sliceBytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, texture.uploadedRows, texture.width, rows, format, GL_UNSIGNED_BYTE, (void*)0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    texture.uploadedRows += rows;
+    if (texture.uploadedRows < texture.height)
+        return false;
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    freePixels(texture);
+    texture.isReady = true;
+    return true;
+}
+
+// Uploads the next precomputed level through the staging buffer, returns true once every level is in
+bool AsyncTextureLoader::uploadCompressedSlice(AsyncTexture &texture)
+{
+    const KTX2Level &level = texture.compressed.levels[texture.uploadedLevels];
+    glBindTexture(GL_TEXTURE_2D, texture.texture);
+    if (texture.uploadedLevels == 0)
+        labelObject(GL_TEXTURE, texture.texture, texture.path);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, std::max<size_t>(level.size, TEXTURE_STAGING_BYTES), NULL, GL_STREAM_DRAW);
+    void *staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, level.size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (staging)
+    {
+        std::memcpy(staging, texture.compressed.data.data() + level.offset, level.size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        uploadCompressedLevel(texture.compressed, texture.uploadedLevels, (void*)0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!staging)
+    {
+        std::cout << "ERROR::TEXTURE_LOADER::FAILED_TO_MAP_STAGING_BUFFER: " << texture.cookedPath << std::endl;
+        texture.isFailed = true;
+        return true;
+    }
+
+    texture.uploadedLevels++;
+    if (texture.uploadedLevels < texture.compressed.levels.size())
+        return false;
+
+    texture.compressed = KTX2Image();
+    texture.isReady = true;
+    return true;
+}
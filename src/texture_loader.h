@@ -0,0 +1,135 @@
+#pragma once
+
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "glad/glad.h"
+#include "asset_io.h"
+#include "asset_pack.h"
+#include "ktx2.h"
+#include "texture.h"
+#include "image_allocator.h"
+#include "staging_heap.h"
+#include "texture_cache.h"
+
+// Rows are streamed through a pixel buffer of this size, larger images take several slices
+const unsigned int TEXTURE_STAGING_BYTES = 4 * 1024 * 1024;
+
+// Persistently mapped heap workers decode into when the context supports it, images that do not fit use the staging buffer
+const size_t TEXTURE_DECODE_HEAP_BYTES = 64 * 1024 * 1024;
+
+struct AsyncTexture
+{
+    std::string path;
+    std::string cookedPath;    // Tried first, path is decoded if it is missing or unsupported
+    TextureUsage usage = TEXTURE_USAGE_COLOR;
+
+    // Files outside the asset pack are read ahead through the AssetReader when the loader has one, the worker waits on the tickets
+    std::vector<unsigned char> sourceBytes;
+    std::vector<unsigned char> cookedBytes;
+    unsigned int sourceRead = ASSET_READ_NONE;
+    unsigned int cookedRead = ASSET_READ_NONE;
+    unsigned int texture = 0;
+    bool isReady = false;
+    bool isFailed = false;
+
+    // Decoded image, owned until the upload finishes. Staged images live in the decode heap and upload from its offset.
+    unsigned char *pixels = nullptr;
+    bool isStaged = false;
+    size_t stagingRegion = 0;
+    int width = 0;
+    int height = 0;
+    TextureImport import;      // Internal format is also set for cooked images, for the stats
+    int uploadedRows = 0;
+    double uploadMs = 0.0;
+    ImageDecodeStats decodeStats;
+
+    // Imported pixels mapped from the decode cache, uploaded in place of pixels
+    TextureCacheEntry cached;
+    bool isCached = false;
+
+    // Cooked image, uploaded one level per slice
+    bool isCompressed = false;
+    KTX2Image compressed;
+    unsigned int uploadedLevels = 0;
+
+    // Cache bookkeeping
+    std::string key;             // Normalized paths the texture was requested with
+    uint64_t contentHash = 0;
+    int aliasOf = -1;            // Same bytes as an earlier texture, which holds the GL texture
+    unsigned int refCount = 0;
+    size_t residentBytes = 0;
+    bool isSettled = false;      // Left the upload queue, ready or failed
+    bool isReleased = false;
+};
+
+// Reads land in the byte vectors while the textures array may grow, moving them must keep their storage
+static_assert(std::is_nothrow_move_constructible<AsyncTexture>::value, "AsyncTexture must move without copying its buffers");
+
+// Decodes images on a worker pool and uploads them through a PBO in time-sliced batches on the GL thread.
+// Requests are deduplicated by normalized path and by file content, handles are reference counted.
+// With a cache directory, imported images are kept on disk by content hash and mapped instead of decoded on later runs.
+class AsyncTextureLoader
+{
+    public:
+
+    // Methods
+    void init(unsigned int workerCount = 0, const char *cacheDirectory = nullptr, AssetReader *reader = nullptr,
+              const AssetPack *pack = nullptr);
+    void destroy();
+    unsigned int request(const char *path, const char *cookedPath = nullptr, TextureUsage usage = TEXTURE_USAGE_COLOR);
+    void acquire(unsigned int handle);
+    void release(unsigned int handle);
+    void update(double budgetMs);
+    void finish();
+    bool isIdle();
+    unsigned int getTexture(unsigned int handle) const;
+    size_t getResidentBytes() const;
+    unsigned int getResidentCount() const;
+    void printStats() const;
+
+    private:
+
+    std::vector<AsyncTexture> textures;
+    std::vector<std::thread> workers;
+    unsigned int placeholder = 0;
+    unsigned int stagingBuffer = 0;
+    StagingHeap decodeHeap;
+    TextureCache decodeCache;
+    AssetReader *assetReader = nullptr;
+    const AssetPack *assetPack = nullptr;      // Entries are decoded in place, must outlive the loader
+    unsigned int pendingCount = 0;
+    std::vector<unsigned int> supportedFormats;    // Compressed internal formats, queried once in init
+    std::unordered_map<std::string, unsigned int> pathIndex;
+    size_t residentBytes = 0;
+    unsigned int residentCount = 0;
+    unsigned int pathHits = 0;
+    unsigned int contentHits = 0;
+    unsigned int cacheHits = 0;
+    unsigned int cacheMisses = 0;
+
+    // Shared with the workers
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<unsigned int> decodeQueue;
+    std::deque<unsigned int> uploadQueue;
+    std::unordered_map<uint64_t, unsigned int> hashIndex;
+    bool isStopping = false;
+
+    static std::string normalizePath(const char *path);
+    void decodeLoop();
+    void freeTexture(AsyncTexture &texture);
+    void freePixels(AsyncTexture &texture);
+    bool uploadSlice(AsyncTexture &texture);
+    bool uploadCompressedSlice(AsyncTexture &texture);
+};
+#endif
@@ -0,0 +1,313 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "texture_residency.h"
+#include "texture.h"
+#include "ktx2.h"
+#include "glad/glad.h"
+#include "stb_image.h"
+#include "image_allocator.h"
+#include "gl_debug.h"
+
+// Next level of a decoded chain, see downsampleLevel
+static StreamedLevel downsample(const StreamedLevel &source, int components, bool isSRGB)
+{
+    StreamedLevel level;
+    level.width = std::max(source.width / 2, 1);
+    level.height = std::max(source.height / 2, 1);
+    level.data = downsampleLevel(source.data.data(), source.width, source.height, components, isSRGB);
+    return level;
+}
+
+// Bytes of the chain from topLevel down to 1x1
+static size_t chainBytes(const StreamedTexture &texture, unsigned int topLevel)
+{
+    size_t bytes = 0;
+    for (unsigned int level = topLevel; level < texture.levels.size(); level++)
+        bytes += texture.levels[level].data.size();
+    return bytes;
+}
+
+// Requires a current GL context, a budget of 0 keeps every requested level resident
+// Files are looked up in pack first when it is open
+void TextureResidency::init(size_t budgetBytes, const AssetPack *pack)
+{
+    this->budgetBytes = budgetBytes;
+    assetPack = pack && pack->isOpen() ? pack : nullptr;
+    frame = 1;
+}
+
+void TextureResidency::destroy()
+{
+    for (StreamedTexture &texture : textures)
+        if (texture.texture)
+            glDeleteTextures(1, &texture.texture);
+    textures.clear();
+    residentBytes = 0;
+}
+
+// Reads every level into system memory and makes the tail resident, finer levels stream in once touched.
+// Cooked files keep their precomputed levels, images go through the import stage and are box filtered.
+unsigned int TextureResidency::add(const char *path, const char *cookedPath, TextureUsage usage)
+{
+    StreamedTexture texture;
+    texture.path = path;
+
+    KTX2Image image;
+    if (cookedPath && readAssetKTX2(assetPack, cookedPath, image) && isCompressedFormatSupported(ktx2InternalFormat(image.vkFormat)))
+    {
+        texture.import.internalFormat = ktx2InternalFormat(image.vkFormat);
+        for (const KTX2Level &info : image.levels)
+        {
+            StreamedLevel level;
+            level.width = info.width;
+            level.height = info.height;
+            level.data.assign(image.data.begin() + info.offset, image.data.begin() + info.offset + info.size);
+            texture.levels.push_back(std::move(level));
+        }
+    }
+    else
+    {
+        int width, height, nrComponents;
+        unsigned char *data = decodeAssetImage(assetPack, path, &width, &height, &nrComponents, 4);
+        if (!data)
+        {
+            std::cout << "ERROR::TEXTURE_RESIDENCY::FAILED_TO_LOAD: " << path << std::endl;
+            textures.push_back(texture);
+            return static_cast<unsigned int>(textures.size()) - 1;
+        }
+
+        texture.import = importTexture(data, width, height, usage);
+        StreamedLevel level;
+        level.width = width;
+        level.height = height;
+        level.data.assign(data, data + static_cast<size_t>(width) * height * texture.import.components);
+        stbi_image_free(data);
+        texture.levels.push_back(std::move(level));
+        while (texture.levels.back().width > 1 || texture.levels.back().height > 1)
+            texture.levels.push_back(downsample(texture.levels.back(), texture.import.components,
+                                                texture.import.internalFormat == GL_SRGB8_ALPHA8));
+    }
+
+    texture.tailLevel = static_cast<unsigned int>(texture.levels.size()) - 1;
+    for (unsigned int level = 0; level < texture.levels.size(); level++)
+        if (texture.levels[level].width <= RESIDENCY_TAIL_SIZE && texture.levels[level].height <= RESIDENCY_TAIL_SIZE)
+        {
+            texture.tailLevel = level;
+            break;
+        }
+    texture.residentLevel = texture.requestedLevel = texture.targetLevel = texture.tailLevel;
+    allocate(texture, texture.tailLevel);
+
+    textures.push_back(std::move(texture));
+    return static_cast<unsigned int>(textures.size()) - 1;
+}
+
+// Reports the on-screen size of a surface the texture covers this frame, the largest one wins
+void TextureResidency::touch(unsigned int handle, float projectedPixels)
+{
+    if (handle >= textures.size() || textures[handle].levels.empty())
+        return;
+
+    // One texel per pixel at the requested level
+    StreamedTexture &texture = textures[handle];
+    float texels = static_cast<float>(std::max(texture.levels[0].width, texture.levels[0].height));
+    float texelsPerPixel = projectedPixels > 0.f ? texels / projectedPixels : texels;
+    unsigned int level = std::min(static_cast<unsigned int>(std::floor(std::log2(std::max(texelsPerPixel, 1.f)))), texture.tailLevel);
+
+    texture.requestedLevel = texture.lastUsedFrame == frame ? std::min(texture.requestedLevel, level) : level;
+    texture.lastUsedFrame = frame;
+}
+
+// Evicts down to the budget, then streams requested levels in until budgetMs is spent. Call once per frame after touching.
+void TextureResidency::update(double budgetMs)
+{
+    // Finer levels are only wanted once they have been requested for a few frames, levels already resident are kept
+    std::vector<unsigned int> wanted(textures.size());
+    for (unsigned int i = 0; i < textures.size(); i++)
+    {
+        StreamedTexture &texture = textures[i];
+        bool isRequestingFiner = texture.lastUsedFrame == frame && texture.requestedLevel < texture.allocatedLevel;
+        texture.requestFrames = isRequestingFiner ? texture.requestFrames + 1 : 0;
+        wanted[i] = texture.requestFrames >= RESIDENCY_STREAM_IN_FRAMES ? texture.requestedLevel : texture.allocatedLevel;
+    }
+    fitBudget(wanted);
+
+    // Evict first so stream-ins never push the total over the budget
+    for (unsigned int i = 0; i < textures.size(); i++)
+    {
+        StreamedTexture &texture = textures[i];
+        texture.targetLevel = wanted[i];
+        if (!texture.levels.empty() && wanted[i] > texture.allocatedLevel)
+        {
+            evictedLevels += wanted[i] - texture.allocatedLevel;
+            allocate(texture, wanted[i]);
+        }
+    }
+    for (StreamedTexture &texture : textures)
+        if (!texture.levels.empty() && texture.targetLevel < texture.allocatedLevel)
+            allocate(texture, texture.targetLevel);
+
+    // Coarsest pending level first, a texture sharpens one level at a time
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < budgetMs)
+    {
+        StreamedTexture *next = nullptr;
+        for (StreamedTexture &texture : textures)
+            if (texture.residentLevel > texture.allocatedLevel &&
+                (!next || texture.levels[texture.residentLevel - 1].data.size() < next->levels[next->residentLevel - 1].data.size()))
+                next = &texture;
+        if (!next)
+            break;
+
+        glBindTexture(GL_TEXTURE_2D, next->texture);
+        uploadLevel(*next, next->residentLevel - 1);
+        next->residentLevel--;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(next->residentLevel - next->allocatedLevel));
+        streamedLevels++;
+    }
+    frame++;
+}
+
+// Drops the finest wanted level of the best victim until the total fits: levels finer than the screen needs go first,
+// then the least recently used texture, then the largest level. Tails are never dropped.
+void TextureResidency::fitBudget(std::vector<unsigned int> &wanted) const
+{
+    std::vector<unsigned int> drops;
+    size_t total = 0;
+    for (unsigned int i = 0; i < textures.size(); i++)
+        total += chainBytes(textures[i], wanted[i]);
+
+    while (budgetBytes && total > budgetBytes)
+    {
+        int victim = -1;
+        for (unsigned int i = 0; i < textures.size(); i++)
+        {
+            const StreamedTexture &texture = textures[i];
+            if (wanted[i] >= texture.tailLevel)
+                continue;
+            if (victim < 0)
+            {
+                victim = static_cast<int>(i);
+                continue;
+            }
+
+            const StreamedTexture &best = textures[victim];
+            bool isSurplus = wanted[i] < texture.requestedLevel || texture.lastUsedFrame != frame;
+            bool isBestSurplus = wanted[victim] < best.requestedLevel || best.lastUsedFrame != frame;
+            if (isSurplus != isBestSurplus)
+            {
+                if (isSurplus)
+                    victim = static_cast<int>(i);
+            }
+            else if (texture.lastUsedFrame != best.lastUsedFrame)
+            {
+                if (texture.lastUsedFrame < best.lastUsedFrame)
+                    victim = static_cast<int>(i);
+            }
+            else if (texture.levels[wanted[i]].data.size() > best.levels[wanted[victim]].data.size())
+                victim = static_cast<int>(i);
+        }
+        if (victim < 0)
+            break;
+
+        total -= textures[victim].levels[wanted[victim]].data.size();
+        wanted[victim]++;
+        drops.push_back(static_cast<unsigned int>(victim));
+    }
+
+    // Levels dropped to make room for one that still did not fit are restored, latest drop first
+    for (std::vector<unsigned int>::reverse_iterator i = drops.rbegin(); i != drops.rend(); i++)
+    {
+        const StreamedLevel &level = textures[*i].levels[wanted[*i] - 1];
+        if (total + level.data.size() <= budgetBytes)
+        {
+            total += level.data.size();
+            wanted[*i]--;
+        }
+    }
+}
+
+// Replaces the storage with one whose finest level is topLevel and uploads the resident levels it covers
+void TextureResidency::allocate(StreamedTexture &texture, unsigned int topLevel)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    labelObject(GL_TEXTURE, textureID, texture.path.c_str());
+
+    // Immutable storage, the mutable fallback specifies compressed levels as they are uploaded
+    GLsizei levelCount = static_cast<GLsizei>(texture.levels.size() - topLevel);
+    if (texture.import.format)
+        allocateTexture(texture.import, texture.levels[topLevel].width, texture.levels[topLevel].height, levelCount);
+    else
+    {
+        if (hasTextureStorage())
+            glTexStorage2D(GL_TEXTURE_2D, levelCount, texture.import.internalFormat, texture.levels[topLevel].width, texture.levels[topLevel].height);
+        setTextureSwizzle(texture.import.internalFormat);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    texture.allocatedLevel = topLevel;
+    texture.residentLevel = std::max(texture.residentLevel, topLevel);
+    for (unsigned int level = texture.residentLevel; level < texture.levels.size(); level++)
+        uploadLevel(texture, level);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(texture.residentLevel - topLevel));
+
+    if (texture.texture)
+        glDeleteTextures(1, &texture.texture);
+    texture.texture = textureID;
+    residentBytes -= texture.residentBytes;
+    texture.residentBytes = chainBytes(texture, topLevel);
+    residentBytes += texture.residentBytes;
+}
+
+// Uploads a source level into the bound texture, storage level 0 is the allocated level
+void TextureResidency::uploadLevel(StreamedTexture &texture, unsigned int level)
+{
+    const StreamedLevel &source = texture.levels[level];
+    GLint storageLevel = static_cast<GLint>(level - texture.allocatedLevel);
+    GLsizei size = static_cast<GLsizei>(source.data.size());
+    if (texture.import.format == 0)
+    {
+        if (hasTextureStorage())
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, storageLevel, 0, 0, source.width, source.height, texture.import.internalFormat, size, source.data.data());
+        else
+            glCompressedTexImage2D(GL_TEXTURE_2D, storageLevel, texture.import.internalFormat, source.width, source.height, 0, size, source.data.data());
+        return;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, storageLevel, 0, 0, source.width, source.height, texture.import.format, GL_UNSIGNED_BYTE, source.data.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+unsigned int TextureResidency::getTexture(unsigned int handle) const
+{
+    return handle < textures.size() ? textures[handle].texture : 0;
+}
+
+size_t TextureResidency::getResidentBytes() const
+{
+    return residentBytes;
+}
+
+void TextureResidency::printStats() const
+{
+    std::cout << "Texture residency: " << textures.size() << " textures, " << std::fixed << std::setprecision(2)
+              << residentBytes / (1024.0 * 1024.0) << " MiB resident";
+    if (budgetBytes)
+        std::cout << " of " << budgetBytes / (1024.0 * 1024.0) << " MiB budget";
+    std::cout << ", " << streamedLevels << " levels streamed in, " << evictedLevels << " evicted" << std::endl;
+}
+
+float projectedPixels(float worldSize, float distance, float fovRadians, unsigned int viewportHeight)
+{
+    return worldSize * viewportHeight / (2.f * std::tan(fovRadians / 2.f) * std::max(distance, .001f));
+}
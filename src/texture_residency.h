@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "texture.h"
+#include "asset_pack.h"
+
+// Levels at or below this size are never evicted, so every texture always has something to sample
+const int RESIDENCY_TAIL_SIZE = 64;
+
+// Frames a finer request has to persist before its levels stream in, keeps camera jitter from thrashing
+const unsigned int RESIDENCY_STREAM_IN_FRAMES = 8;
+
+struct StreamedLevel
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> data;
+};
+
+// Every source level stays in system memory, finest first, the GL texture holds the chain from allocatedLevel down.
+// Levels between allocatedLevel and residentLevel are allocated but still streaming in, GL_TEXTURE_BASE_LEVEL hides them.
+struct StreamedTexture
+{
+    std::string path;
+    unsigned int texture = 0;
+    TextureImport import;                // Pixel transfer format is 0 for compressed levels
+    std::vector<StreamedLevel> levels;
+
+    unsigned int tailLevel = 0;          // Coarsest level that can be the top of the chain
+    unsigned int allocatedLevel = 0;
+    unsigned int residentLevel = 0;
+    unsigned int requestedLevel = 0;     // Finest level the screen needed the last time the texture was touched
+    unsigned int targetLevel = 0;
+    unsigned int requestFrames = 0;      // Consecutive frames a level finer than allocated was requested
+    uint64_t lastUsedFrame = 0;
+    size_t residentBytes = 0;
+};
+
+// Keeps textures under a VRAM budget by streaming mip levels in and out of immutable storage.
+// Textures report their screen-space footprint each frame, levels they do not need and the high mips of
+// the least recently used textures are evicted first when the budget is exceeded.
+class TextureResidency
+{
+    public:
+
+    // Methods
+    void init(size_t budgetBytes, const AssetPack *pack = nullptr);
+    void destroy();
+    unsigned int add(const char *path, const char *cookedPath = nullptr, TextureUsage usage = TEXTURE_USAGE_COLOR);
+    void touch(unsigned int handle, float projectedPixels);
+    void update(double budgetMs);
+    unsigned int getTexture(unsigned int handle) const;
+    size_t getResidentBytes() const;
+    void printStats() const;
+
+    private:
+
+    std::vector<StreamedTexture> textures;
+    const AssetPack *assetPack = nullptr;
+    size_t budgetBytes = 0;
+    size_t residentBytes = 0;
+    uint64_t frame = 1;
+    unsigned int streamedLevels = 0;
+    unsigned int evictedLevels = 0;
+
+    void allocate(StreamedTexture &texture, unsigned int topLevel);
+    void uploadLevel(StreamedTexture &texture, unsigned int level);
+    void fitBudget(std::vector<unsigned int> &wanted) const;
+};
+
+// Height in pixels of an object of worldSize at distance, for touch
+float projectedPixels(float worldSize, float distance, float fovRadians, unsigned int viewportHeight);
+#endif
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <chrono>
+#include "glad/glad.h"
+#include "trace.h"
+
+Tracer tracer;
+
+void TraceBuffer::push(const char *name, uint64_t start, uint64_t end)
+{
+    uint64_t index = writeIndex.load(std::memory_order_relaxed);
+    TraceEvent &event = events[index % TRACE_BUFFER_CAPACITY];
+    event.name = name;
+    event.start = start;
+    event.duration = end > start ? end - start : 0;
+    writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    this->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Tracer::isEnabled() const
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::addCpuEvent(const char *name, uint64_t start, uint64_t end)
+{
+    if (!isEnabled())
+        return;
+    getThreadBuffer()->push(name, start, end);
+}
+
+// GPU timestamps are moved onto the CPU timeline with the last calibration offset
+void Tracer::addGpuEvent(const char *name, uint64_t gpuStart, uint64_t gpuEnd)
+{
+    if (!isEnabled() || !isGpuClockCalibrated.load(std::memory_order_acquire))
+        return;
+
+    int64_t offset = gpuClockOffset.load(std::memory_order_relaxed);
+    gpuBuffer->push(name, gpuStart + offset, gpuEnd + offset);
+}
+
+// Pair GL_TIMESTAMP with the steady clock, requires a current GL context
+void Tracer::calibrateGpuClock()
+{
+    GLint64 gpuTime = 0;
+    uint64_t before = now();
+    glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+    uint64_t after = now();
+
+    int64_t cpuTime = static_cast<int64_t>(before + (after - before) / 2);
+    if (!gpuBuffer)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        gpuBuffer.reset(new TraceBuffer());
+    }
+    gpuClockOffset.store(cpuTime - gpuTime, std::memory_order_relaxed);
+    isGpuClockCalibrated.store(true, std::memory_order_release);
+}
+
+uint64_t Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceBuffer *Tracer::getThreadBuffer()
+{
+    thread_local TraceBuffer *buffer = nullptr;
+    if (!buffer)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.emplace_back(new TraceBuffer());
+        buffer = buffers.back().get();
+        buffer->threadId = buffers.size();
+    }
+    return buffer;
+}
+
+// Chrome trace-event JSON, open with Perfetto (ui.perfetto.dev) or chrome://tracing
+bool Tracer::writeChromeTrace(const char *path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::TRACE::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // Earliest retained event becomes time zero
+    std::vector<const TraceBuffer*> all;
+    for (const std::unique_ptr<TraceBuffer> &buffer : buffers)
+        all.push_back(buffer.get());
+    if (gpuBuffer)
+        all.push_back(gpuBuffer.get());
+
+    uint64_t origin = UINT64_MAX;
+    for (const TraceBuffer *buffer : all)
+    {
+        uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_BUFFER_CAPACITY ? end - TRACE_BUFFER_CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++)
+            origin = std::min(origin, buffer->events[i % TRACE_BUFFER_CAPACITY].start);
+    }
+    if (origin == UINT64_MAX)
+        origin = 0;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const TraceBuffer *buffer : all)
+    {
+        bool isGpu = buffer == gpuBuffer.get();
+        unsigned int tid = isGpu ? 0 : buffer->threadId;
+
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+             << ",\"args\":{\"name\":\"" << (isGpu ? "GPU" : "CPU ") << (isGpu ? "" : std::to_string(tid)) << "\"}}";
+        first = false;
+
+        uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_BUFFER_CAPACITY ? end - TRACE_BUFFER_CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++)
+        {
+            const TraceEvent &event = buffer->events[i % TRACE_BUFFER_CAPACITY];
+            file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << (isGpu ? "gpu" : "cpu")
+                 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                 << ",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << '}';
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+TraceScope::TraceScope(const char *name) : name(name), start(tracer.isEnabled() ? Tracer::now() : 0)
+{
+}
+
+TraceScope::~TraceScope()
+{
+    if (start)
+        tracer.addCpuEvent(name, start, Tracer::now());
+}
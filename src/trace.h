@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Events kept per thread, older events are overwritten once the ring is full
+const unsigned int TRACE_BUFFER_CAPACITY = 1 << 16;
+
+struct TraceEvent
+{
+    const char *name;    // Must outlive the tracer (string literals)
+    uint64_t start;      // Nanoseconds on the steady clock
+    uint64_t duration;
+};
+
+// Single-producer ring, only the owning thread writes and the exporter reads up to writeIndex
+struct TraceBuffer
+{
+    TraceEvent events[TRACE_BUFFER_CAPACITY];
+    std::atomic<uint64_t> writeIndex{0};
+    unsigned int threadId = 0;
+
+    void push(const char *name, uint64_t start, uint64_t end);
+};
+
+class Tracer
+{
+    public:
+
+    // Methods
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void addCpuEvent(const char *name, uint64_t start, uint64_t end);
+    void addGpuEvent(const char *name, uint64_t gpuStart, uint64_t gpuEnd);
+    void calibrateGpuClock();
+    bool writeChromeTrace(const char *path) const;
+    static uint64_t now();
+
+    private:
+
+    std::atomic<bool> enabled{false};
+    std::atomic<int64_t> gpuClockOffset{0};
+    std::atomic<bool> isGpuClockCalibrated{false};
+
+    // Locked only when a thread records its first event and on export
+    mutable std::mutex registryMutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::unique_ptr<TraceBuffer> gpuBuffer;
+
+    TraceBuffer *getThreadBuffer();
+};
+
+extern Tracer tracer;
+
+// Records the enclosing block as a CPU event on the calling thread
+class TraceScope
+{
+    public:
+
+    TraceScope(const char *name);
+    ~TraceScope();
+
+    private:
+
+    const char *name;
+    uint64_t start;
+};
+#endif
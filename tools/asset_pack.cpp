@@ -0,0 +1,111 @@
+// Asset packer: loose files in, one assets.pack with a sorted, aligned table of contents out.
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "asset_pack.h"
+
+struct PackInput
+{
+    std::string name;
+    std::string path;
+    std::vector<unsigned char> bytes;
+};
+
+static size_t alignUp(size_t value)
+{
+    return (value + ASSET_PACK_ALIGNMENT - 1) & ~(ASSET_PACK_ALIGNMENT - 1);
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse arguments
+    const char *outputPath = NULL;
+    std::vector<PackInput> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t separator = arg.find('=');
+        if (!outputPath && separator == std::string::npos)
+            outputPath = argv[i];
+        else if (separator != std::string::npos && separator > 0)
+            inputs.push_back({ arg.substr(0, separator), arg.substr(separator + 1), {} });
+        else
+        {
+            outputPath = NULL;
+            break;
+        }
+    }
+    if (!outputPath || inputs.empty())
+    {
+        std::cout << "Usage: " << argv[0] << " <output.pack> <name>=<file>...\n"
+                  << "       names are what the renderer looks up, relative to the project root (assets/container2.png)" << std::endl;
+        return -1;
+    }
+
+    // Read inputs, the table is sorted by name for binary search at runtime
+    for (PackInput &input : inputs)
+    {
+        std::ifstream file(input.path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::ASSET_PACK::FAILED_TO_READ: " << input.path << std::endl;
+            return -1;
+        }
+        input.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::sort(inputs.begin(), inputs.end(), [](const PackInput &a, const PackInput &b) { return a.name < b.name; });
+    for (size_t i = 1; i < inputs.size(); i++)
+        if (inputs[i].name == inputs[i - 1].name)
+        {
+            std::cout << "ERROR::ASSET_PACK::DUPLICATE_NAME: " << inputs[i].name << std::endl;
+            return -1;
+        }
+
+    // Lay out header, table, names, then every entry on its own aligned offset
+    AssetPackHeader header;
+    std::memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC));
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(inputs.size());
+    header.tocOffset = alignUp(sizeof(AssetPackHeader));
+    header.namesOffset = header.tocOffset + inputs.size() * sizeof(AssetPackEntry);
+
+    std::string names;
+    std::vector<AssetPackEntry> entries(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameLength = static_cast<uint32_t>(inputs[i].name.size());
+        names += inputs[i].name;
+    }
+    size_t offset = alignUp(header.namesOffset + names.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        entries[i].offset = offset;
+        entries[i].size = entries[i].storedSize = inputs[i].bytes.size();
+        entries[i].hash = hashAssetBytes(inputs[i].bytes.data(), inputs[i].bytes.size());
+        entries[i].compression = ASSET_COMPRESSION_NONE;
+        entries[i].reserved = 0;
+        offset = alignUp(offset + inputs[i].bytes.size());
+    }
+
+    std::vector<unsigned char> file(offset, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + header.tocOffset, entries.data(), entries.size() * sizeof(AssetPackEntry));
+    std::memcpy(file.data() + header.namesOffset, names.data(), names.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+        std::copy(inputs[i].bytes.begin(), inputs[i].bytes.end(), file.begin() + entries[i].offset);
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out.write(reinterpret_cast<const char*>(file.data()), file.size()))
+    {
+        std::cout << "ERROR::ASSET_PACK::FAILED_TO_WRITE: " << outputPath << std::endl;
+        return -1;
+    }
+    std::cout << "Packed " << inputs.size() << " files into " << outputPath << " (" << file.size() / 1024 << " KiB)" << std::endl;
+    return 0;
+}
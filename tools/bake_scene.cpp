@@ -0,0 +1,138 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "stb_image.h"
+#include "scene.h"
+#include "texture.h"
+#include "bake_scene.h"
+
+// Cubes in world space and the albedo map that tints bounce light
+bool buildBakeScene(BakeScene &scene, unsigned int objectCount, unsigned int pointLightCount, const char *albedoPath)
+{
+    scene.pointLightCount = pointLightCount;
+    int components;
+    unsigned char *pixels = stbi_load(albedoPath, &scene.albedoWidth, &scene.albedoHeight, &components, 3);
+    if (!pixels)
+    {
+        std::cout << "ERROR::BAKE::FAILED_TO_LOAD: " << albedoPath << std::endl;
+        return false;
+    }
+    scene.albedo.resize(static_cast<size_t>(scene.albedoWidth) * scene.albedoHeight);
+    for (size_t i = 0; i < scene.albedo.size(); i++)
+        scene.albedo[i] = linearColor(glm::vec3(pixels[i * 3], pixels[i * 3 + 1], pixels[i * 3 + 2]) / 255.f);
+    stbi_image_free(pixels);
+
+    for (unsigned int instance = 0; instance < objectCount; instance++)
+    {
+        glm::mat4 model = cubeModelMatrix(instance);
+        glm::mat3 normalModel = normalMatrix(model);
+        for (unsigned int vertex = 0; vertex < CUBE_VERTEX_COUNT; vertex++)
+        {
+            const float *data = &CUBE_VERTICES[vertex * CUBE_VERTEX_STRIDE];
+            scene.positions.push_back(glm::vec3(model * glm::vec4(data[0], data[1], data[2], 1.f)));
+            scene.texCoords.push_back(glm::vec2(data[6], data[7]));
+            if (vertex % 3 == 0)
+                scene.normals.push_back(glm::normalize(normalModel * glm::vec3(data[3], data[4], data[5])));
+        }
+    }
+    scene.bvh.build(scene.positions);
+    return true;
+}
+
+// Diffuse lighting of the static lights with shadows, in the units cube_frag.glsl multiplies by the diffuse map
+glm::vec3 directIrradiance(const BakeScene &scene, const glm::vec3 &position, const glm::vec3 &normal)
+{
+    glm::vec3 origin = position + normal * RAY_EPSILON;
+    glm::vec3 irradiance(0.f);
+
+    glm::vec3 lightDir = glm::normalize(-DIR_LIGHT_DIRECTION);
+    float diff = glm::dot(normal, lightDir);
+    if (diff > 0.f && !scene.bvh.isOccluded(origin, lightDir, std::numeric_limits<float>::max()))
+        irradiance += DIR_LIGHT_DIFFUSE * diff;
+
+    for (unsigned int i = 0; i < scene.pointLightCount; i++)
+    {
+        glm::vec3 toLight = POINT_LIGHT_POSITIONS[i] - position;
+        float distance = glm::length(toLight);
+        lightDir = toLight / distance;
+        diff = glm::dot(normal, lightDir);
+        if (diff <= 0.f || scene.bvh.isOccluded(origin, lightDir, distance - RAY_EPSILON))
+            continue;
+        float attenuation = 1.f / (LIGHT_CONSTANT + LIGHT_LINEAR * distance + LIGHT_QUADRATIC * (distance * distance));
+        irradiance += POINT_LIGHT_COLORS[i] * (diff * attenuation);
+    }
+    return irradiance;
+}
+
+static glm::vec3 sampleAlbedo(const BakeScene &scene, const glm::vec2 &texCoords)
+{
+    int x = static_cast<int>(texCoords.x * scene.albedoWidth), y = static_cast<int>(texCoords.y * scene.albedoHeight);
+    x = std::min(std::max(x, 0), scene.albedoWidth - 1);
+    y = std::min(std::max(y, 0), scene.albedoHeight - 1);
+    return scene.albedo[static_cast<size_t>(y) * scene.albedoWidth + x];
+}
+
+// Light arriving from direction: follows one path, adding the direct light reflected at every vertex it reaches.
+// Nothing is emitted into empty space and paths that start inside a cube return black.
+glm::vec3 incomingRadiance(const BakeScene &scene, glm::vec3 origin, glm::vec3 direction, unsigned int bounceCount, uint32_t &random)
+{
+    glm::vec3 radiance(0.f), throughput(1.f);
+    for (unsigned int bounce = 0; bounce < bounceCount; bounce++)
+    {
+        BVHHit hit;
+        if (!scene.bvh.intersect(origin, direction, std::numeric_limits<float>::max(), hit))
+            break;
+        glm::vec3 normal = scene.normals[hit.triangle];
+        if (glm::dot(normal, direction) > 0.f)
+            break;
+
+        const glm::vec2 *uv = &scene.texCoords[hit.triangle * 3];
+        glm::vec3 position = origin + direction * hit.t;
+        throughput *= sampleAlbedo(scene, uv[0] * (1.f - hit.u - hit.v) + uv[1] * hit.u + uv[2] * hit.v);
+        radiance += throughput * directIrradiance(scene, position, normal);
+
+        origin = position + normal * RAY_EPSILON;
+        direction = sampleHemisphere(normal, random);
+    }
+    return radiance;
+}
+
+uint32_t seedRandom(size_t index)
+{
+    uint32_t state = static_cast<uint32_t>(index) * 747796405u + 2891336453u;
+    state = ((state >> ((state >> 28) + 4)) ^ state) * 277803737u;
+    return ((state >> 22) ^ state) | 1u;
+}
+
+// xorshift32, 24 bits of the state become a float in [0, 1)
+float nextRandom(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.f / 16777216.f);
+}
+
+// Cosine-weighted direction around normal, the pdf cancels the cosine in the irradiance integral
+glm::vec3 sampleHemisphere(const glm::vec3 &normal, uint32_t &random)
+{
+    float sign = std::copysign(1.f, normal.z);
+    float a = -1.f / (sign + normal.z);
+    float b = normal.x * normal.y * a;
+    glm::vec3 tangent(1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+    glm::vec3 bitangent(b, sign + normal.y * normal.y * a, -normal.y);
+
+    float u = nextRandom(random), v = nextRandom(random);
+    float radius = std::sqrt(u), angle = 6.28318531f * v;
+    return tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) + normal * std::sqrt(1.f - u);
+}
+
+// Uniform direction over the whole sphere
+glm::vec3 sampleSphere(uint32_t &random)
+{
+    float z = 1.f - 2.f * nextRandom(random);
+    float radius = std::sqrt(std::max(0.f, 1.f - z * z)), angle = 6.28318531f * nextRandom(random);
+    return glm::vec3(radius * std::cos(angle), radius * std::sin(angle), z);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef BAKE_SCENE_H
+#define BAKE_SCENE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bvh.h"
+
+// Offset along the surface normal for rays leaving a surface, cubes are one unit across
+const float RAY_EPSILON = 1e-3f;
+
+// World-space cubes and static lights the offline bakers trace against, one normal and three albedo map
+// coordinates per triangle
+struct BakeScene
+{
+    BVH4 bvh;
+    std::vector<glm::vec3> positions;    // Three per triangle, cube after cube
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> albedo;       // Linear RGB
+    int albedoWidth = 0;
+    int albedoHeight = 0;
+    unsigned int pointLightCount = 0;
+};
+
+// Methods
+bool buildBakeScene(BakeScene &scene, unsigned int objectCount, unsigned int pointLightCount, const char *albedoPath);
+glm::vec3 directIrradiance(const BakeScene &scene, const glm::vec3 &position, const glm::vec3 &normal);
+glm::vec3 incomingRadiance(const BakeScene &scene, glm::vec3 origin, glm::vec3 direction, unsigned int bounceCount, uint32_t &random);
+
+// Sampling, generators are seeded per texel or probe so results do not depend on the thread count
+uint32_t seedRandom(size_t index);
+float nextRandom(uint32_t &state);
+glm::vec3 sampleHemisphere(const glm::vec3 &normal, uint32_t &random);
+glm::vec3 sampleSphere(uint32_t &random);
+#endif
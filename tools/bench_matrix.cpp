@@ -0,0 +1,431 @@
+// Sweeps the headless benchmark over a settings matrix, stores results per commit and compares them against a baseline.
+// Exits non-zero when a configured percentile regresses past the threshold with statistical significance.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "benchmark.h"
+
+struct MatrixMode
+{
+    std::string name;
+    std::string arguments;
+};
+
+struct MatrixSettings
+{
+    std::string executable = "./learn_opengl_linux_project";
+    std::string resultsDirectory = "bench_results";
+    unsigned int warmupFrames = 100;
+    unsigned int measuredFrames = 1000;
+    std::vector<std::string> sizes = { "1080x1080" };
+    std::vector<unsigned int> objectCounts = { 10 };
+    std::vector<unsigned int> lightCounts = { 4 };
+    std::vector<MatrixMode> modes = { { "default", "" } };
+    std::vector<std::string> metrics = { "cpu_frame_ms", "gpu_frame_ms" };
+    double percentile = 95.0;
+    double threshold = 5.0;    // Allowed percentile increase in percent
+    double alpha = .01;        // Significance level of the one-sided Mann-Whitney U test
+};
+
+struct MatrixConfig
+{
+    std::string name;
+    std::string arguments;
+};
+
+struct Comparison
+{
+    std::string config;
+    std::string metric;
+    double baseline = 0.0;
+    double current = 0.0;
+    double change = 0.0;    // Percent
+    double pValue = 1.0;
+    bool isRegression = false;
+};
+
+// Config file: one "<key> <values...>" per line, '#' starts a comment
+bool loadSettings(const char *path, MatrixSettings &settings)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::BENCH_MATRIX::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    bool hasSizes = false, hasObjects = false, hasLights = false, hasModes = false, hasMetrics = false;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        std::string key;
+        stream >> key;
+        if (key == "executable")
+            stream >> settings.executable;
+        else if (key == "results")
+            stream >> settings.resultsDirectory;
+        else if (key == "warmup")
+            stream >> settings.warmupFrames;
+        else if (key == "frames")
+            stream >> settings.measuredFrames;
+        else if (key == "percentile")
+            stream >> settings.percentile;
+        else if (key == "threshold")
+            stream >> settings.threshold;
+        else if (key == "alpha")
+            stream >> settings.alpha;
+        else if (key == "size")
+        {
+            if (!hasSizes)
+                settings.sizes.clear();
+            hasSizes = true;
+            for (std::string size; stream >> size;)
+                settings.sizes.push_back(size);
+        }
+        else if (key == "objects")
+        {
+            if (!hasObjects)
+                settings.objectCounts.clear();
+            hasObjects = true;
+            for (unsigned int count; stream >> count;)
+                settings.objectCounts.push_back(count);
+        }
+        else if (key == "lights")
+        {
+            if (!hasLights)
+                settings.lightCounts.clear();
+            hasLights = true;
+            for (unsigned int count; stream >> count;)
+                settings.lightCounts.push_back(count);
+        }
+        else if (key == "metric")
+        {
+            if (!hasMetrics)
+                settings.metrics.clear();
+            hasMetrics = true;
+            for (std::string metric; stream >> metric;)
+                settings.metrics.push_back(metric);
+        }
+        else if (key == "mode")
+        {
+            // mode <name> [extra renderer arguments...]
+            if (!hasModes)
+                settings.modes.clear();
+            hasModes = true;
+            MatrixMode mode;
+            stream >> mode.name;
+            std::getline(stream, mode.arguments);
+            settings.modes.push_back(mode);
+        }
+        else
+        {
+            std::cout << "ERROR::BENCH_MATRIX::UNKNOWN_KEY: " << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<MatrixConfig> buildMatrix(const MatrixSettings &settings)
+{
+    std::vector<MatrixConfig> configs;
+    for (const std::string &size : settings.sizes)
+        for (unsigned int objects : settings.objectCounts)
+            for (unsigned int lights : settings.lightCounts)
+                for (const MatrixMode &mode : settings.modes)
+                {
+                    MatrixConfig config;
+                    config.name = size + "_o" + std::to_string(objects) + "_l" + std::to_string(lights) + "_" + mode.name;
+                    config.arguments = " --size " + size + " --objects " + std::to_string(objects) +
+                                       " --lights " + std::to_string(lights) + " " + mode.arguments;
+                    configs.push_back(config);
+                }
+    return configs;
+}
+
+std::string runCommand(const std::string &command)
+{
+    std::string output;
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe)
+        return output;
+    char buffer[256];
+    while (std::fgets(buffer, sizeof(buffer), pipe))
+        output += buffer;
+    pclose(pipe);
+    while (!output.empty() && (output.back() == '\n' || output.back() == '\r'))
+        output.pop_back();
+    return output;
+}
+
+// Short hash of HEAD, marked dirty when the working tree has local changes
+std::string currentCommit()
+{
+    std::string commit = runCommand("git rev-parse --short HEAD 2>/dev/null");
+    if (commit.empty())
+        return "unknown";
+    if (!runCommand("git status --porcelain --untracked-files=no 2>/dev/null").empty())
+        commit += "-dirty";
+    return commit;
+}
+
+// Read one metric column of a <prefix>_frames.csv
+bool loadFrameSamples(const std::string &path, const std::string &metric, std::vector<double> &samples)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    if (!std::getline(file, line))
+        return false;
+    std::istringstream header(line);
+    int column = -1;
+    std::string name;
+    for (int i = 0; std::getline(header, name, ','); i++)
+        if (name == metric)
+            column = i;
+    if (column < 0)
+    {
+        std::cout << "ERROR::BENCH_MATRIX::MISSING_METRIC: " << metric << " in " << path << std::endl;
+        return false;
+    }
+
+    // Empty fields are frames without a sample (e.g. an unresolved GPU timer), short or garbled rows are skipped too
+    samples.clear();
+    while (std::getline(file, line))
+    {
+        std::istringstream row(line);
+        std::string value;
+        int i = 0;
+        while (i <= column && std::getline(row, value, ','))
+            i++;
+        if (i <= column || value.empty())
+            continue;
+        char *end = NULL;
+        double sample = std::strtod(value.c_str(), &end);
+        if (end != value.c_str() + value.size() || !std::isfinite(sample))
+            continue;
+        samples.push_back(sample);
+    }
+    if (samples.empty())
+    {
+        std::cout << "ERROR::BENCH_MATRIX::NO_SAMPLES: " << metric << " in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Nearest-rank percentile, matching Benchmark::summarize
+double percentileOf(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+    return values[std::min(std::max<size_t>(rank, 1), values.size()) - 1];
+}
+
+// One-sided Mann-Whitney U test (normal approximation with tie correction).
+// Small p-values mean the current samples tend to be larger than the baseline samples.
+double mannWhitneyPValue(const std::vector<double> &baseline, const std::vector<double> &current)
+{
+    double n1 = static_cast<double>(current.size());
+    double n2 = static_cast<double>(baseline.size());
+    if (n1 == 0 || n2 == 0)
+        return 1.0;
+
+    // Pool the samples, tagging which side they came from
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(current.size() + baseline.size());
+    for (double value : current)
+        pooled.push_back({ value, true });
+    for (double value : baseline)
+        pooled.push_back({ value, false });
+    std::sort(pooled.begin(), pooled.end());
+
+    // Average ranks over ties
+    double currentRankSum = 0.0;
+    double tieCorrection = 0.0;
+    for (size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first)
+            j++;
+        double rank = (i + 1 + j) * .5;
+        double ties = static_cast<double>(j - i);
+        tieCorrection += ties * ties * ties - ties;
+        for (size_t k = i; k < j; k++)
+            if (pooled[k].second)
+                currentRankSum += rank;
+        i = j;
+    }
+
+    double n = n1 + n2;
+    double u = currentRankSum - n1 * (n1 + 1) * .5;
+    double mean = n1 * n2 * .5;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (variance <= 0.0)
+        return 1.0;
+    double z = (u - mean) / std::sqrt(variance);
+    return .5 * std::erfc(z / std::sqrt(2.0));
+}
+
+// Append the summary of every metric to <results>/results.csv
+bool appendResults(const MatrixSettings &settings, const std::string &commit, const MatrixConfig &config)
+{
+    std::string path = settings.resultsDirectory + "/results.csv";
+    bool isNew = !std::ifstream(path);
+    std::ofstream file(path, std::ios::app);
+    if (isNew)
+        file << "commit,config,metric,mean,median,p95,p99,max,low1\n";
+    file << std::fixed << std::setprecision(4);
+
+    std::string framesPath = settings.resultsDirectory + "/" + commit + "/" + config.name + "_frames.csv";
+    for (const std::string &metric : settings.metrics)
+    {
+        std::vector<double> samples;
+        if (!loadFrameSamples(framesPath, metric, samples))
+            return false;
+        BenchmarkSummary s = Benchmark::summarize(samples);
+        file << commit << ',' << config.name << ',' << metric << ',' << s.mean << ',' << s.median << ','
+             << s.p95 << ',' << s.p99 << ',' << s.max << ',' << s.low1 << '\n';
+    }
+    return true;
+}
+
+bool runConfig(const MatrixSettings &settings, const std::string &commit, const MatrixConfig &config)
+{
+    std::string prefix = settings.resultsDirectory + "/" + commit + "/" + config.name;
+    std::string command = settings.executable + " --headless --benchmark --no-flight-recorder" +
+                          " --warmup " + std::to_string(settings.warmupFrames) +
+                          " --frames " + std::to_string(settings.measuredFrames) +
+                          " --output " + prefix + config.arguments;
+    std::cout << "Running " << config.name << std::endl;
+    if (std::system(command.c_str()) != 0)
+    {
+        std::cout << "ERROR::BENCH_MATRIX::RUN_FAILED: " << command << std::endl;
+        return false;
+    }
+    return appendResults(settings, commit, config);
+}
+
+std::vector<Comparison> compare(const MatrixSettings &settings, const std::vector<MatrixConfig> &configs,
+                                const std::string &baseline, const std::string &commit)
+{
+    std::vector<Comparison> comparisons;
+    for (const MatrixConfig &config : configs)
+        for (const std::string &metric : settings.metrics)
+        {
+            std::vector<double> baselineSamples, currentSamples;
+            if (!loadFrameSamples(settings.resultsDirectory + "/" + baseline + "/" + config.name + "_frames.csv", metric, baselineSamples) ||
+                !loadFrameSamples(settings.resultsDirectory + "/" + commit + "/" + config.name + "_frames.csv", metric, currentSamples))
+                continue;
+
+            Comparison comparison;
+            comparison.config = config.name;
+            comparison.metric = metric;
+            comparison.baseline = percentileOf(baselineSamples, settings.percentile);
+            comparison.current = percentileOf(currentSamples, settings.percentile);
+            if (comparison.baseline > 0.0)
+                comparison.change = (comparison.current - comparison.baseline) / comparison.baseline * 100.0;
+            comparison.pValue = mannWhitneyPValue(baselineSamples, currentSamples);
+            comparison.isRegression = comparison.change > settings.threshold && comparison.pValue < settings.alpha;
+            comparisons.push_back(comparison);
+        }
+    return comparisons;
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse arguments
+    const char *configPath = NULL;
+    std::string commit;
+    std::string baseline;
+    bool shouldRun = true;
+    bool shouldSetBaseline = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--commit" && i + 1 < argc)
+            commit = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            baseline = argv[++i];
+        else if (arg == "--set-baseline")
+            shouldSetBaseline = true;
+        else if (arg == "--no-run")
+            shouldRun = false;
+        else if (!configPath && arg[0] != '-')
+            configPath = argv[i];
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [<matrix.cfg>] [--commit <id>] [--baseline <id>] [--set-baseline] [--no-run]" << std::endl;
+            return 2;
+        }
+    }
+
+    MatrixSettings settings;
+    if (configPath && !loadSettings(configPath, settings))
+        return 2;
+    if (commit.empty())
+        commit = currentCommit();
+    std::string baselinePath = settings.resultsDirectory + "/baseline";
+    if (baseline.empty())
+        std::getline(std::ifstream(baselinePath), baseline);
+
+    // Run every configuration for this commit
+    std::vector<MatrixConfig> configs = buildMatrix(settings);
+    if (shouldRun)
+    {
+        mkdir(settings.resultsDirectory.c_str(), 0755);
+        mkdir((settings.resultsDirectory + "/" + commit).c_str(), 0755);
+        for (const MatrixConfig &config : configs)
+            if (!runConfig(settings, commit, config))
+                return 2;
+    }
+
+    if (shouldSetBaseline)
+    {
+        std::ofstream(baselinePath) << commit << '\n';
+        std::cout << "Baseline set to " << commit << std::endl;
+        return 0;
+    }
+    if (baseline.empty())
+    {
+        std::cout << "No baseline to compare against, store one with --set-baseline" << std::endl;
+        return 0;
+    }
+    if (baseline == commit)
+        return 0;
+
+    // Compare against the baseline
+    std::vector<Comparison> comparisons = compare(settings, configs, baseline, commit);
+    int regressions = 0;
+    std::cout << "p" << settings.percentile << " of " << commit << " against baseline " << baseline
+              << " (threshold " << settings.threshold << "%, alpha " << settings.alpha << ")\n"
+              << std::fixed << std::setprecision(3);
+    for (const Comparison &c : comparisons)
+    {
+        std::cout << (c.isRegression ? "REGRESSION " : "           ")
+                  << std::left << std::setw(36) << c.config << std::setw(16) << c.metric << std::right
+                  << std::setw(10) << c.baseline << " -> " << std::setw(10) << c.current
+                  << std::showpos << std::setw(9) << c.change << "%" << std::noshowpos
+                  << "  p=" << c.pValue << '\n';
+        regressions += c.isRegression;
+    }
+    std::cout << regressions << " regression(s) in " << comparisons.size() << " comparisons" << std::endl;
+    return regressions ? 1 : 0;
+}
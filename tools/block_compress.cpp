@@ -0,0 +1,490 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "block_compress.h"
+
+// Principal axis of the texel colours (first `channels` components) by power iteration
+static void principalAxis(const unsigned char *block, int channels, float *mean, float *axis)
+{
+    for (int c = 0; c < channels; c++)
+    {
+        mean[c] = 0.f;
+        for (int i = 0; i < 16; i++)
+            mean[c] += block[i * 4 + c];
+        mean[c] /= 16.f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+        for (int a = 0; a < channels; a++)
+            for (int b = 0; b < channels; b++)
+                covariance[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+
+    for (int c = 0; c < channels; c++)
+        axis[c] = 1.f;
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {};
+        for (int a = 0; a < channels; a++)
+            for (int b = 0; b < channels; b++)
+                next[a] += covariance[a][b] * axis[b];
+        float length = 0.f;
+        for (int c = 0; c < channels; c++)
+            length = std::max(length, std::fabs(next[c]));
+        if (length < 1e-6f)
+            break;
+        for (int c = 0; c < channels; c++)
+            axis[c] = next[c] / length;
+    }
+}
+
+// Endpoints at the extremes of the texels projected onto the principal axis
+static void fitEndpoints(const unsigned char *block, int channels, float *low, float *high)
+{
+    float mean[4], axis[4];
+    principalAxis(block, channels, mean, axis);
+
+    float minT = 0.f, maxT = 0.f;
+    float lengthSquared = 0.f;
+    for (int c = 0; c < channels; c++)
+        lengthSquared += axis[c] * axis[c];
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.f;
+        for (int c = 0; c < channels; c++)
+            t += (block[i * 4 + c] - mean[c]) * axis[c];
+        t /= lengthSquared;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (int c = 0; c < channels; c++)
+    {
+        low[c] = std::min(std::max(mean[c] + axis[c] * minT, 0.f), 255.f);
+        high[c] = std::min(std::max(mean[c] + axis[c] * maxT, 0.f), 255.f);
+    }
+}
+
+// -- BC1 --
+
+static uint16_t packRGB565(const float *color)
+{
+    int r = static_cast<int>(std::lround(color[0] * 31.f / 255.f));
+    int g = static_cast<int>(std::lround(color[1] * 63.f / 255.f));
+    int b = static_cast<int>(std::lround(color[2] * 31.f / 255.f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t packed, int *color)
+{
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Picks the nearest of the four palette colours per texel, returns the total squared error
+static int bc1Indices(const unsigned char *block, uint16_t color0, uint16_t color1, uint32_t &indices)
+{
+    int palette[4][3];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    int totalError = 0;
+    indices = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int bestError = 1 << 30, bestIndex = 0;
+        for (int p = 0; p < 4; p++)
+        {
+            int error = 0;
+            for (int c = 0; c < 3; c++)
+            {
+                int d = block[i * 4 + c] - palette[p][c];
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+        indices |= static_cast<uint32_t>(bestIndex) << (2 * i);
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+// Least-squares endpoints for fixed indices, one refinement pass over the PCA fit
+static void refineBC1(const unsigned char *block, uint32_t indices, float *color0, float *color1)
+{
+    const float WEIGHTS[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+    float aa = 0.f, bb = 0.f, ab = 0.f;
+    float ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        float a = WEIGHTS[(indices >> (2 * i)) & 3], b = 1.f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; c++)
+        {
+            ax[c] += a * block[i * 4 + c];
+            bx[c] += b * block[i * 4 + c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+        return;
+    for (int c = 0; c < 3; c++)
+    {
+        color0[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / determinant, 0.f), 255.f);
+        color1[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / determinant, 0.f), 255.f);
+    }
+}
+
+void encodeBC1(const unsigned char *block, unsigned char *out)
+{
+    float low[4], high[4];
+    fitEndpoints(block, 3, low, high);
+
+    uint16_t color0 = packRGB565(high), color1 = packRGB565(low);
+    if (color0 < color1)
+        std::swap(color0, color1);
+    uint32_t indices;
+    int error = bc1Indices(block, color0, color1, indices);
+
+    // Four-colour mode needs color0 > color1, equal endpoints decode index 0 as color0 either way
+    float refined0[3] = { high[0], high[1], high[2] }, refined1[3] = { low[0], low[1], low[2] };
+    refineBC1(block, indices, refined0, refined1);
+    uint16_t refinedColor0 = packRGB565(refined0), refinedColor1 = packRGB565(refined1);
+    if (refinedColor0 < refinedColor1)
+        std::swap(refinedColor0, refinedColor1);
+    uint32_t refinedIndices;
+    if (refinedColor0 != refinedColor1 && bc1Indices(block, refinedColor0, refinedColor1, refinedIndices) < error)
+    {
+        color0 = refinedColor0;
+        color1 = refinedColor1;
+        indices = refinedIndices;
+    }
+    if (color0 == color1)
+        indices = 0;
+
+    out[0] = color0 & 0xFF;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF;
+    out[3] = color1 >> 8;
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+// -- BC4 / BC5 / BC3 --
+
+// Single channel block in eight-value mode (endpoint0 > endpoint1)
+static void encodeBC4Channel(const unsigned char *block, int channel, unsigned char *out)
+{
+    int minValue = 255, maxValue = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minValue = std::min<int>(minValue, block[i * 4 + channel]);
+        maxValue = std::max<int>(maxValue, block[i * 4 + channel]);
+    }
+
+    out[0] = static_cast<unsigned char>(maxValue);
+    out[1] = static_cast<unsigned char>(minValue);
+    uint64_t indices = 0;
+    if (maxValue != minValue)
+    {
+        int palette[8] = { maxValue, minValue };
+        for (int k = 1; k < 7; k++)
+            palette[k + 1] = ((7 - k) * maxValue + k * minValue) / 7;
+
+        for (int i = 0; i < 16; i++)
+        {
+            int bestError = 1 << 30, bestIndex = 0;
+            for (int p = 0; p < 8; p++)
+            {
+                int error = std::abs(block[i * 4 + channel] - palette[p]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(bestIndex) << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+void encodeBC4(const unsigned char *block, unsigned char *out)
+{
+    encodeBC4Channel(block, 0, out);
+}
+
+void encodeBC5(const unsigned char *block, unsigned char *out)
+{
+    encodeBC4Channel(block, 0, out);
+    encodeBC4Channel(block, 1, out + 8);
+}
+
+void encodeBC3(const unsigned char *block, unsigned char *out)
+{
+    encodeBC4Channel(block, 3, out);
+    encodeBC1(block, out + 8);
+}
+
+// -- BC7 --
+
+// Least significant bit first writer over a 16 byte block
+struct BitWriter
+{
+    unsigned char *out;
+    int position = 0;
+
+    void write(uint32_t value, int bits)
+    {
+        for (int i = 0; i < bits; i++, position++)
+            if ((value >> i) & 1)
+                out[position / 8] |= static_cast<unsigned char>(1 << (position % 8));
+    }
+};
+
+void encodeBC7(const unsigned char *block, unsigned char *out)
+{
+    const int WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float endpoints[2][4];
+    fitEndpoints(block, 4, endpoints[0], endpoints[1]);
+
+    // Quantize to 7 bits plus a shared p-bit per endpoint, keeping the p-bit with the lower error
+    int quantized[2][4], pbits[2], expanded[2][4];
+    for (int e = 0; e < 2; e++)
+    {
+        int bestError = 1 << 30;
+        for (int p = 0; p < 2; p++)
+        {
+            int candidate[4], error = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                candidate[c] = std::min(std::max(static_cast<int>(std::lround((endpoints[e][c] - p) / 2.f)), 0), 127);
+                int d = static_cast<int>(endpoints[e][c]) - ((candidate[c] << 1) | p);
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pbits[e] = p;
+                std::memcpy(quantized[e], candidate, sizeof(candidate));
+            }
+        }
+        for (int c = 0; c < 4; c++)
+            expanded[e][c] = (quantized[e][c] << 1) | pbits[e];
+    }
+
+    int palette[16][4];
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 4; c++)
+            palette[i][c] = ((64 - WEIGHTS[i]) * expanded[0][c] + WEIGHTS[i] * expanded[1][c] + 32) >> 6;
+
+    int indices[16];
+    for (int i = 0; i < 16; i++)
+    {
+        int bestError = 1 << 30;
+        for (int p = 0; p < 16; p++)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                int d = block[i * 4 + c] - palette[p][c];
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[i] = p;
+            }
+        }
+    }
+
+    // The anchor index has an implicit zero high bit, swap the endpoints if it would be set
+    if (indices[0] & 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pbits[0], pbits[1]);
+        for (int i = 0; i < 16; i++)
+            indices[i] = 15 - indices[i];
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer = { out };
+    writer.write(1 << 6, 7);    // Mode 6
+    for (int c = 0; c < 4; c++)
+    {
+        writer.write(quantized[0][c], 7);
+        writer.write(quantized[1][c], 7);
+    }
+    writer.write(pbits[0], 1);
+    writer.write(pbits[1], 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; i++)
+        writer.write(indices[i], 4);
+}
+
+// -- ETC2 --
+
+static const int ETC_MODIFIERS[8][4] = {
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 }
+};
+
+// Texels of one half of the block, ETC numbers texels column-major (x * 4 + y)
+static void etcSubblock(int flip, int half, int *texels)
+{
+    int count = 0;
+    for (int x = 0; x < 4; x++)
+        for (int y = 0; y < 4; y++)
+            if ((flip ? y / 2 : x / 2) == half)
+                texels[count++] = x * 4 + y;
+}
+
+// Best modifier table and per-texel modifiers around a base colour, returns the squared error
+static int etcFitTable(const unsigned char *block, const int *texels, const int *base, int &table, int *modifiers)
+{
+    int bestError = 1 << 30;
+    for (int t = 0; t < 8; t++)
+    {
+        int error = 0, candidate[8];
+        for (int i = 0; i < 8; i++)
+        {
+            int x = texels[i] / 4, y = texels[i] % 4;
+            const unsigned char *texel = block + (y * 4 + x) * 4;
+            int bestTexelError = 1 << 30;
+            for (int m = 0; m < 4; m++)
+            {
+                int texelError = 0;
+                for (int c = 0; c < 3; c++)
+                {
+                    int d = texel[c] - std::min(std::max(base[c] + ETC_MODIFIERS[t][m], 0), 255);
+                    texelError += d * d;
+                }
+                if (texelError < bestTexelError)
+                {
+                    bestTexelError = texelError;
+                    candidate[i] = m;
+                }
+            }
+            error += bestTexelError;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            table = t;
+            std::memcpy(modifiers, candidate, sizeof(candidate));
+        }
+    }
+    return bestError;
+}
+
+void encodeETC2(const unsigned char *block, unsigned char *out)
+{
+    uint64_t bestBits = 0;
+    int bestError = 1 << 30;
+
+    for (int flip = 0; flip < 2; flip++)
+    {
+        int texels[2][8];
+        float average[2][3] = {};
+        for (int half = 0; half < 2; half++)
+        {
+            etcSubblock(flip, half, texels[half]);
+            for (int i = 0; i < 8; i++)
+            {
+                int x = texels[half][i] / 4, y = texels[half][i] % 4;
+                for (int c = 0; c < 3; c++)
+                    average[half][c] += block[(y * 4 + x) * 4 + c] / 8.f;
+            }
+        }
+
+        for (int isDifferential = 0; isDifferential < 2; isDifferential++)
+        {
+            int quantized[2][3], base[2][3];
+            bool isValid = true;
+            for (int half = 0; half < 2; half++)
+                for (int c = 0; c < 3; c++)
+                {
+                    if (isDifferential)
+                    {
+                        quantized[half][c] = static_cast<int>(std::lround(average[half][c] * 31.f / 255.f));
+                        base[half][c] = (quantized[half][c] << 3) | (quantized[half][c] >> 2);
+                    }
+                    else
+                    {
+                        quantized[half][c] = static_cast<int>(std::lround(average[half][c] * 15.f / 255.f));
+                        base[half][c] = quantized[half][c] * 17;
+                    }
+                }
+            // Out of range deltas would select the ETC2 T, H or planar modes
+            if (isDifferential)
+                for (int c = 0; c < 3; c++)
+                {
+                    int delta = quantized[1][c] - quantized[0][c];
+                    isValid = isValid && delta >= -4 && delta <= 3;
+                }
+            if (!isValid)
+                continue;
+
+            int tables[2], modifiers[2][8];
+            int error = etcFitTable(block, texels[0], base[0], tables[0], modifiers[0]) +
+                        etcFitTable(block, texels[1], base[1], tables[1], modifiers[1]);
+            if (error >= bestError)
+                continue;
+
+            uint64_t bits = 0;
+            for (int c = 0; c < 3; c++)
+            {
+                int shift = 59 - 8 * c;
+                if (isDifferential)
+                {
+                    bits |= static_cast<uint64_t>(quantized[0][c]) << shift;
+                    bits |= static_cast<uint64_t>((quantized[1][c] - quantized[0][c]) & 7) << (shift - 3);
+                }
+                else
+                {
+                    bits |= static_cast<uint64_t>(quantized[0][c]) << (shift + 1);
+                    bits |= static_cast<uint64_t>(quantized[1][c]) << (shift - 3);
+                }
+            }
+            bits |= static_cast<uint64_t>(tables[0]) << 37;
+            bits |= static_cast<uint64_t>(tables[1]) << 34;
+            bits |= static_cast<uint64_t>(isDifferential) << 33;
+            bits |= static_cast<uint64_t>(flip) << 32;
+            for (int half = 0; half < 2; half++)
+                for (int i = 0; i < 8; i++)
+                {
+                    int texel = texels[half][i];
+                    bits |= static_cast<uint64_t>(modifiers[half][i] >> 1) << (16 + texel);
+                    bits |= static_cast<uint64_t>(modifiers[half][i] & 1) << texel;
+                }
+
+            bestError = error;
+            bestBits = bits;
+        }
+    }
+
+    // Stored big-endian
+    for (int i = 0; i < 8; i++)
+        out[i] = (bestBits >> (56 - 8 * i)) & 0xFF;
+}
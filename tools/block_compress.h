@@ -0,0 +1,21 @@
+#pragma once
+
+#ifndef BLOCK_COMPRESS_H
+#define BLOCK_COMPRESS_H
+
+// Block encoders for the texture cooker. Every encoder takes a 4x4 block of RGBA8 texels
+// in row-major order (64 bytes) and writes one compressed block.
+
+// 8 bytes, opaque RGB in four-colour mode
+void encodeBC1(const unsigned char *block, unsigned char *out);
+// 16 bytes, BC4 alpha followed by BC1 colour
+void encodeBC3(const unsigned char *block, unsigned char *out);
+// 8 bytes, red channel only
+void encodeBC4(const unsigned char *block, unsigned char *out);
+// 16 bytes, red and green as two BC4 blocks
+void encodeBC5(const unsigned char *block, unsigned char *out);
+// 16 bytes, mode 6 only (one subset, RGBA 7.7.7.7 endpoints with p-bits, 4-bit indices)
+void encodeBC7(const unsigned char *block, unsigned char *out);
+// 8 bytes, ETC1-compatible individual/differential modes, valid ETC2 RGB8
+void encodeETC2(const unsigned char *block, unsigned char *out);
+#endif
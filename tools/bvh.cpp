@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "bvh.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const unsigned int BVH_SAH_BINS = 12;
+const unsigned int BVH_MAX_DEPTH = 64;
+
+namespace
+{
+    struct Bounds
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+        void grow(const glm::vec3 &point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+        void grow(const Bounds &bounds)
+        {
+            min = glm::min(min, bounds.min);
+            max = glm::max(max, bounds.max);
+        }
+        float area() const
+        {
+            glm::vec3 extent = max - min;
+            return extent.x < 0.f ? 0.f : 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+        }
+    };
+
+    struct BinaryNode
+    {
+        Bounds bounds;
+        int left = -1;
+        int right = -1;
+        unsigned int first = 0;
+        unsigned int count = 0;
+    };
+
+    struct BuildTriangle
+    {
+        Bounds bounds;
+        glm::vec3 centroid;
+        unsigned int index;
+    };
+
+    // Binned SAH split of [first, first + count) along the longest centroid axis, median split when binning cannot separate
+    int buildBinary(std::vector<BinaryNode> &binaryNodes, std::vector<BuildTriangle> &buildTriangles, unsigned int first,
+                    unsigned int count, unsigned int depth)
+    {
+        BinaryNode node;
+        Bounds centroids;
+        for (unsigned int i = first; i < first + count; i++)
+        {
+            node.bounds.grow(buildTriangles[i].bounds);
+            centroids.grow(buildTriangles[i].centroid);
+        }
+        node.first = first;
+        node.count = count;
+        int nodeIndex = static_cast<int>(binaryNodes.size());
+        binaryNodes.push_back(node);
+
+        glm::vec3 extent = centroids.max - centroids.min;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        if (count <= BVH_LEAF_TRIANGLES || extent[axis] <= 0.f || depth >= BVH_MAX_DEPTH)
+            return nodeIndex;
+
+        Bounds binBounds[BVH_SAH_BINS];
+        unsigned int binCounts[BVH_SAH_BINS] = {};
+        float binScale = BVH_SAH_BINS / extent[axis];
+        auto binOf = [&](const BuildTriangle &triangle) {
+            int bin = static_cast<int>((triangle.centroid[axis] - centroids.min[axis]) * binScale);
+            return static_cast<unsigned int>(std::min(std::max(bin, 0), static_cast<int>(BVH_SAH_BINS) - 1));
+        };
+        for (unsigned int i = first; i < first + count; i++)
+        {
+            unsigned int bin = binOf(buildTriangles[i]);
+            binBounds[bin].grow(buildTriangles[i].bounds);
+            binCounts[bin]++;
+        }
+
+        // Sweep from the right for suffix areas, then from the left to find the cheapest split plane
+        float rightAreas[BVH_SAH_BINS];
+        unsigned int rightCounts[BVH_SAH_BINS];
+        Bounds right;
+        unsigned int rightCount = 0;
+        for (unsigned int bin = BVH_SAH_BINS - 1; bin > 0; bin--)
+        {
+            right.grow(binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightAreas[bin] = right.area();
+            rightCounts[bin] = rightCount;
+        }
+        Bounds left;
+        unsigned int leftCount = 0;
+        unsigned int bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (unsigned int split = 1; split < BVH_SAH_BINS; split++)
+        {
+            left.grow(binBounds[split - 1]);
+            leftCount += binCounts[split - 1];
+            if (leftCount == 0 || rightCounts[split] == 0)
+                continue;
+            float cost = left.area() * leftCount + rightAreas[split] * rightCounts[split];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = split;
+            }
+        }
+
+        unsigned int middle;
+        if (bestSplit == 0)
+        {
+            middle = first + count / 2;
+            std::nth_element(buildTriangles.begin() + first, buildTriangles.begin() + middle, buildTriangles.begin() + first + count,
+                             [axis](const BuildTriangle &a, const BuildTriangle &b) { return a.centroid[axis] < b.centroid[axis]; });
+        }
+        else
+        {
+            auto split = std::partition(buildTriangles.begin() + first, buildTriangles.begin() + first + count,
+                                        [&](const BuildTriangle &triangle) { return binOf(triangle) < bestSplit; });
+            middle = static_cast<unsigned int>(split - buildTriangles.begin());
+        }
+
+        int leftIndex = buildBinary(binaryNodes, buildTriangles, first, middle - first, depth + 1);
+        int rightIndex = buildBinary(binaryNodes, buildTriangles, middle, first + count - middle, depth + 1);
+        binaryNodes[nodeIndex].left = leftIndex;
+        binaryNodes[nodeIndex].right = rightIndex;
+        return nodeIndex;
+    }
+}
+
+void BVH4::build(const std::vector<glm::vec3> &positions)
+{
+    nodes.clear();
+    triangles.clear();
+    unsigned int triangleCount = static_cast<unsigned int>(positions.size() / 3);
+    if (triangleCount == 0)
+        return;
+
+    std::vector<BuildTriangle> buildTriangles(triangleCount);
+    for (unsigned int i = 0; i < triangleCount; i++)
+    {
+        for (unsigned int corner = 0; corner < 3; corner++)
+            buildTriangles[i].bounds.grow(positions[i * 3 + corner]);
+        buildTriangles[i].centroid = (positions[i * 3] + positions[i * 3 + 1] + positions[i * 3 + 2]) / 3.f;
+        buildTriangles[i].index = i;
+    }
+    std::vector<BinaryNode> binaryNodes;
+    binaryNodes.reserve(triangleCount * 2);
+    buildBinary(binaryNodes, buildTriangles, 0, triangleCount, 0);
+
+    triangles.resize(triangleCount);
+    for (unsigned int i = 0; i < triangleCount; i++)
+    {
+        unsigned int index = buildTriangles[i].index;
+        triangles[i].v0 = positions[index * 3];
+        triangles[i].e1 = positions[index * 3 + 1] - positions[index * 3];
+        triangles[i].e2 = positions[index * 3 + 2] - positions[index * 3];
+        triangles[i].index = index;
+    }
+
+    // Collapse: open the largest inner child until a node has four children, then recurse into the inner ones
+    struct Collapse
+    {
+        const std::vector<BinaryNode> &binaryNodes;
+        std::vector<Node> &nodes;
+
+        int operator()(int binaryIndex)
+        {
+            std::vector<int> children;
+            const BinaryNode &binary = binaryNodes[binaryIndex];
+            if (binary.left < 0)
+                children.push_back(binaryIndex);
+            else
+                children = { binary.left, binary.right };
+            while (children.size() < 4)
+            {
+                int widest = -1;
+                for (int i = 0; i < static_cast<int>(children.size()); i++)
+                    if (binaryNodes[children[i]].left >= 0 &&
+                        (widest < 0 || binaryNodes[children[i]].bounds.area() > binaryNodes[children[widest]].bounds.area()))
+                        widest = i;
+                if (widest < 0)
+                    break;
+                int opened = children[widest];
+                children[widest] = binaryNodes[opened].left;
+                children.push_back(binaryNodes[opened].right);
+            }
+
+            int nodeIndex = static_cast<int>(nodes.size());
+            nodes.emplace_back();
+            Node node = {};
+            node.childCount = static_cast<uint32_t>(children.size());
+            for (unsigned int i = 0; i < 4; i++)
+            {
+                // Unused slots are never tested, childCount masks them out
+                Bounds bounds = i < children.size() ? binaryNodes[children[i]].bounds : Bounds();
+                node.minX[i] = bounds.min.x;
+                node.minY[i] = bounds.min.y;
+                node.minZ[i] = bounds.min.z;
+                node.maxX[i] = bounds.max.x;
+                node.maxY[i] = bounds.max.y;
+                node.maxZ[i] = bounds.max.z;
+                node.children[i] = 0;
+                node.counts[i] = 0;
+                if (i >= children.size())
+                    continue;
+                const BinaryNode &child = binaryNodes[children[i]];
+                if (child.left < 0)
+                {
+                    node.children[i] = ~static_cast<int32_t>(child.first);
+                    node.counts[i] = child.count;
+                }
+                else
+                    node.children[i] = (*this)(children[i]);
+            }
+            nodes[nodeIndex] = node;
+            return nodeIndex;
+        }
+    };
+    nodes.reserve(binaryNodes.size() / 2 + 1);
+    Collapse{ binaryNodes, nodes }(0);
+}
+
+template <bool isAnyHit>
+bool BVH4::traverse(const glm::vec3 &origin, const glm::vec3 &direction, float tMax, BVHHit &hit) const
+{
+    if (nodes.empty())
+        return false;
+    glm::vec3 inverse = 1.f / direction;
+#if defined(__SSE2__)
+    const __m128 originX = _mm_set1_ps(origin.x), originY = _mm_set1_ps(origin.y), originZ = _mm_set1_ps(origin.z);
+    const __m128 inverseX = _mm_set1_ps(inverse.x), inverseY = _mm_set1_ps(inverse.y), inverseZ = _mm_set1_ps(inverse.z);
+#endif
+
+    int32_t stack[BVH_MAX_DEPTH * 3 + 4];
+    unsigned int stackSize = 0;
+    stack[stackSize++] = 0;
+    bool isHit = false;
+    while (stackSize > 0)
+    {
+        const Node &node = nodes[stack[--stackSize]];
+
+        // Slab test against all four children at once
+        unsigned int mask;
+#if defined(__SSE2__)
+        __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), originX), inverseX);
+        __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), originX), inverseX);
+        __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), originY), inverseY);
+        __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), originY), inverseY);
+        __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), originZ), inverseZ);
+        __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), originZ), inverseZ);
+        __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)), _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+        __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(tMax)));
+        mask = static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+#else
+        mask = 0;
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            float x0 = (node.minX[i] - origin.x) * inverse.x, x1 = (node.maxX[i] - origin.x) * inverse.x;
+            float y0 = (node.minY[i] - origin.y) * inverse.y, y1 = (node.maxY[i] - origin.y) * inverse.y;
+            float z0 = (node.minZ[i] - origin.z) * inverse.z, z1 = (node.maxZ[i] - origin.z) * inverse.z;
+            float tNear = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.f));
+            float tFar = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), tMax));
+            mask |= static_cast<unsigned int>(tNear <= tFar) << i;
+        }
+#endif
+        mask &= (1u << node.childCount) - 1;
+
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+            if (node.counts[i] == 0)
+            {
+                stack[stackSize++] = node.children[i];
+                continue;
+            }
+
+            // Leaf, Moller-Trumbore against each triangle
+            unsigned int first = static_cast<unsigned int>(~node.children[i]);
+            for (unsigned int index = first; index < first + node.counts[i]; index++)
+            {
+                const Triangle &triangle = triangles[index];
+                glm::vec3 p = glm::cross(direction, triangle.e2);
+                float determinant = glm::dot(triangle.e1, p);
+                if (std::fabs(determinant) < 1e-12f)
+                    continue;
+                float inverseDeterminant = 1.f / determinant;
+                glm::vec3 s = origin - triangle.v0;
+                float u = glm::dot(s, p) * inverseDeterminant;
+                if (u < 0.f || u > 1.f)
+                    continue;
+                glm::vec3 q = glm::cross(s, triangle.e1);
+                float v = glm::dot(direction, q) * inverseDeterminant;
+                if (v < 0.f || u + v > 1.f)
+                    continue;
+                float t = glm::dot(triangle.e2, q) * inverseDeterminant;
+                if (t <= 0.f || t >= tMax)
+                    continue;
+                if (isAnyHit)
+                    return true;
+                tMax = t;
+                hit.t = t;
+                hit.u = u;
+                hit.v = v;
+                hit.triangle = triangle.index;
+                isHit = true;
+            }
+        }
+    }
+    return isHit;
+}
+
+bool BVH4::intersect(const glm::vec3 &origin, const glm::vec3 &direction, float tMax, BVHHit &hit) const
+{
+    return traverse<false>(origin, direction, tMax, hit);
+}
+
+bool BVH4::isOccluded(const glm::vec3 &origin, const glm::vec3 &direction, float tMax) const
+{
+    BVHHit hit;
+    return traverse<true>(origin, direction, tMax, hit);
+}
+
+unsigned int BVH4::getNodeCount() const
+{
+    return static_cast<unsigned int>(nodes.size());
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Triangles per leaf before the builder stops splitting
+const unsigned int BVH_LEAF_TRIANGLES = 4;
+
+struct BVHHit
+{
+    float t = 0.f;
+    float u = 0.f;                // Barycentric weights of the second and third vertex
+    float v = 0.f;
+    unsigned int triangle = 0;    // Index into the positions passed to build
+};
+
+// Four-wide BVH over static triangles. Each node holds the bounds of its four children in SoA order so one SSE slab
+// test covers all of them, built by collapsing a binned SAH binary tree. Queries are read-only and thread safe.
+class BVH4
+{
+    public:
+
+    // Methods
+    void build(const std::vector<glm::vec3> &positions);
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, float tMax, BVHHit &hit) const;
+    bool isOccluded(const glm::vec3 &origin, const glm::vec3 &direction, float tMax) const;
+    unsigned int getNodeCount() const;
+
+    private:
+
+    struct Node
+    {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        int32_t children[4];     // Inner node index, or ~first triangle for a leaf
+        uint32_t counts[4];      // Triangles in a leaf child, 0 for inner children
+        uint32_t childCount;
+    };
+
+    // Triangles in leaf order, stored as a vertex and two edges for the intersection test
+    struct Triangle
+    {
+        glm::vec3 v0;
+        glm::vec3 e1;
+        glm::vec3 e2;
+        unsigned int index;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+
+    template <bool isAnyHit>
+    bool traverse(const glm::vec3 &origin, const glm::vec3 &direction, float tMax, BVHHit &hit) const;
+};
+#endif
@@ -0,0 +1,222 @@
+// Offline lightmap baker: path traces the directional and point lights over the static cubes on every core and writes
+// the RGBA16F atlas cube_frag.glsl samples with BAKED_LIGHTING. Only the flashlight is left to the renderer.
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include "scene.h"
+#include "lightmap.h"
+#include "bake_scene.h"
+
+struct BakeSettings
+{
+    unsigned int objectCount = CUBE_COUNT;
+    unsigned int pointLightCount = POINT_LIGHT_COUNT;
+    unsigned int faceTexels = LIGHTMAP_FACE_TEXELS;
+    unsigned int sampleCount = 256;
+    unsigned int bounceCount = 3;
+    unsigned int threadCount = 0;    // 0 uses every core
+};
+
+// Texels handed to a worker at a time
+const size_t BAKE_CHUNK_TEXELS = 64;
+
+// Atlas texel covered by a cube face
+struct BakeTexel
+{
+    size_t index;
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+int main(int argc, char *argv[])
+{
+    // Parse arguments
+    const char *outputPath = NULL;
+    const char *albedoPath = NULL;
+    BakeSettings settings;
+    bool isValid = true;
+
+    // Numbers are parsed like the renderer's, a malformed or negative value falls through to the usage text
+    for (int i = 1; i < argc && isValid; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--objects" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.objectCount) == 1;
+        else if (arg == "--lights" && i + 1 < argc)
+        {
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.pointLightCount) == 1;
+            settings.pointLightCount = std::min(settings.pointLightCount, POINT_LIGHT_COUNT);
+        }
+        else if (arg == "--texels" && i + 1 < argc)
+        {
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.faceTexels) == 1;
+            settings.faceTexels = std::max(settings.faceTexels, 1u);
+        }
+        else if (arg == "--samples" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.sampleCount) == 1;
+        else if (arg == "--bounces" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.bounceCount) == 1;
+        else if (arg == "--threads" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.threadCount) == 1;
+        else if (!outputPath)
+            outputPath = argv[i];
+        else if (!albedoPath)
+            albedoPath = argv[i];
+        else
+            isValid = false;
+    }
+    if (!isValid || !outputPath || !albedoPath)
+    {
+        std::cout << "Usage: " << argv[0] << " <output> <albedo image> [--objects <count>] [--lights <0-" << POINT_LIGHT_COUNT << ">]\n"
+                  << "       [--texels <per face>] [--samples <per texel>] [--bounces <count>] [--threads <count>]\n"
+                  << "       --objects and --lights must match the renderer's, the albedo image tints bounce light" << std::endl;
+        return -1;
+    }
+
+    LightmapLayout layout = lightmapLayout(settings.objectCount, settings.faceTexels);
+    if (settings.objectCount == 0 || layout.width > 16384 || layout.height > 16384)
+    {
+        std::cout << "ERROR::LIGHTMAP_BAKE::ATLAS_TOO_LARGE: " << layout.width << "x" << layout.height << std::endl;
+        return -1;
+    }
+
+    BakeScene scene;
+    if (!buildBakeScene(scene, settings.objectCount, settings.pointLightCount, albedoPath))
+        return -1;
+
+    // Rasterize every triangle into the atlas through its lightmap UVs, each covered texel is traced once
+    glm::vec2 lightmapUVs[CUBE_VERTEX_COUNT];
+    buildCubeLightmapUVs(layout.faceTexels, lightmapUVs);
+    size_t texelCount = static_cast<size_t>(layout.width) * layout.height;
+    std::vector<unsigned char> isCovered(texelCount, 0);
+    std::vector<BakeTexel> texels;
+    glm::vec2 atlasSize(static_cast<float>(layout.width), static_cast<float>(layout.height));
+    for (unsigned int instance = 0; instance < settings.objectCount; instance++)
+    {
+        glm::vec4 scaleOffset = lightmapScaleOffset(layout, instance);
+        for (unsigned int triangle = 0; triangle < CUBE_VERTEX_COUNT / 3; triangle++)
+        {
+            glm::vec2 corners[3];
+            glm::vec3 worldCorners[3];
+            for (unsigned int corner = 0; corner < 3; corner++)
+            {
+                unsigned int vertex = triangle * 3 + corner;
+                corners[corner] = (lightmapUVs[vertex] * glm::vec2(scaleOffset.x, scaleOffset.y) + glm::vec2(scaleOffset.z, scaleOffset.w)) * atlasSize;
+                worldCorners[corner] = scene.positions[instance * CUBE_VERTEX_COUNT + vertex];
+            }
+            float area = (corners[1].x - corners[0].x) * (corners[2].y - corners[0].y) - (corners[2].x - corners[0].x) * (corners[1].y - corners[0].y);
+            if (std::fabs(area) < 1e-8f)
+                continue;
+            int minX = static_cast<int>(std::floor(std::min({ corners[0].x, corners[1].x, corners[2].x })));
+            int maxX = static_cast<int>(std::ceil(std::max({ corners[0].x, corners[1].x, corners[2].x })));
+            int minY = static_cast<int>(std::floor(std::min({ corners[0].y, corners[1].y, corners[2].y })));
+            int maxY = static_cast<int>(std::ceil(std::max({ corners[0].y, corners[1].y, corners[2].y })));
+            for (int y = std::max(minY, 0); y < std::min(maxY, static_cast<int>(layout.height)); y++)
+                for (int x = std::max(minX, 0); x < std::min(maxX, static_cast<int>(layout.width)); x++)
+                {
+                    glm::vec2 center(x + .5f, y + .5f);
+                    float weights[3];
+                    for (unsigned int corner = 0; corner < 3; corner++)
+                    {
+                        const glm::vec2 &a = corners[(corner + 1) % 3], &b = corners[(corner + 2) % 3];
+                        weights[corner] = ((b.x - a.x) * (center.y - a.y) - (center.x - a.x) * (b.y - a.y)) / area;
+                    }
+                    size_t index = static_cast<size_t>(y) * layout.width + x;
+                    if (weights[0] < -1e-4f || weights[1] < -1e-4f || weights[2] < -1e-4f || isCovered[index])
+                        continue;
+                    isCovered[index] = 1;
+                    glm::vec3 position = worldCorners[0] * weights[0] + worldCorners[1] * weights[1] + worldCorners[2] * weights[2];
+                    texels.push_back({ index, position, scene.normals[(instance * CUBE_VERTEX_COUNT) / 3 + triangle] });
+                }
+        }
+    }
+
+    // Trace on every core, texels are claimed in small chunks so uneven occlusion still balances
+    unsigned int threadCount = settings.threadCount ? settings.threadCount : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<glm::vec3> irradiance(texelCount, glm::vec3(0.f));
+    std::atomic<size_t> nextTexel(0);
+    auto startTime = std::chrono::steady_clock::now();
+    auto work = [&]() {
+        while (true)
+        {
+            size_t first = nextTexel.fetch_add(BAKE_CHUNK_TEXELS);
+            if (first >= texels.size())
+                break;
+            for (size_t i = first; i < std::min(first + BAKE_CHUNK_TEXELS, texels.size()); i++)
+            {
+                const BakeTexel &texel = texels[i];
+                uint32_t random = seedRandom(texel.index);
+                glm::vec3 indirect(0.f);
+                glm::vec3 origin = texel.position + texel.normal * RAY_EPSILON;
+                for (unsigned int sample = 0; sample < settings.sampleCount; sample++)
+                    indirect += incomingRadiance(scene, origin, sampleHemisphere(texel.normal, random), settings.bounceCount, random);
+                if (settings.sampleCount > 0)
+                    indirect /= static_cast<float>(settings.sampleCount);
+                irradiance[texel.index] = directIrradiance(scene, texel.position, texel.normal) + indirect;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCount; i++)
+        threads.emplace_back(work);
+    for (std::thread &thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // Grow each chart into its gutter so bilinear filtering at the edges only sees its own chart
+    for (unsigned int pass = 0; pass <= LIGHTMAP_GUTTER_TEXELS; pass++)
+    {
+        std::vector<unsigned char> wasCovered = isCovered;
+        for (int y = 0; y < static_cast<int>(layout.height); y++)
+            for (int x = 0; x < static_cast<int>(layout.width); x++)
+            {
+                size_t index = static_cast<size_t>(y) * layout.width + x;
+                if (wasCovered[index])
+                    continue;
+                glm::vec3 sum(0.f);
+                unsigned int count = 0;
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        int nx = x + dx, ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= static_cast<int>(layout.width) || ny >= static_cast<int>(layout.height))
+                            continue;
+                        size_t neighbour = static_cast<size_t>(ny) * layout.width + nx;
+                        if (wasCovered[neighbour])
+                        {
+                            sum += irradiance[neighbour];
+                            count++;
+                        }
+                    }
+                if (count == 0)
+                    continue;
+                irradiance[index] = sum / static_cast<float>(count);
+                isCovered[index] = 1;
+            }
+    }
+
+    std::vector<uint16_t> halfTexels(texelCount * 4);
+    for (size_t i = 0; i < texelCount; i++)
+    {
+        halfTexels[i * 4] = glm::packHalf1x16(irradiance[i].r);
+        halfTexels[i * 4 + 1] = glm::packHalf1x16(irradiance[i].g);
+        halfTexels[i * 4 + 2] = glm::packHalf1x16(irradiance[i].b);
+        halfTexels[i * 4 + 3] = glm::packHalf1x16(1.f);
+    }
+    if (!writeLightmap(outputPath, layout, settings.pointLightCount, halfTexels))
+        return -1;
+    std::cout << "Baked " << texels.size() << " texels (" << layout.width << "x" << layout.height << ", " << settings.sampleCount
+              << " samples, " << settings.bounceCount << " bounces) on " << threadCount << " threads in " << seconds << " s, "
+              << scene.bvh.getNodeCount() << " BVH nodes -> " << outputPath << std::endl;
+    return 0;
+}
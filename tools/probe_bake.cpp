@@ -0,0 +1,212 @@
+// Offline irradiance probe baker: path traces the bounce light of the directional and point lights at every probe of a
+// grid around the static cubes on every core and writes L2 spherical harmonics for cube_frag.glsl with PROBE_LIGHTING.
+// Direct lighting stays per fragment, the probes only replace the ambient terms.
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include "scene.h"
+#include "light_probes.h"
+#include "bake_scene.h"
+
+struct BakeSettings
+{
+    unsigned int objectCount = CUBE_COUNT;
+    unsigned int pointLightCount = POINT_LIGHT_COUNT;
+    float spacing = LIGHT_PROBE_SPACING;
+    unsigned int sampleCount = 4096;
+    unsigned int bounceCount = 3;
+    unsigned int threadCount = 0;    // 0 uses every core
+};
+
+// Probes that see the inside of a cube in more than this share of directions are replaced by their neighbours
+const float INVALID_PROBE_BACKFACES = .1f;
+
+// Clamped cosine convolution of each band over pi, turns projected radiance into the irradiance units the shader
+// multiplies by the diffuse map
+const float SH_BAND_IRRADIANCE[3] = { 1.f, 2.f / 3.f, .25f };
+const unsigned int SH_COEFFICIENT_BAND[SH_COEFFICIENT_COUNT] = { 0, 1, 1, 1, 2, 2, 2, 2, 2 };
+
+// Real L2 basis, same order and constants as cube_frag.glsl
+void shBasis(const glm::vec3 &d, float basis[SH_COEFFICIENT_COUNT])
+{
+    basis[0] = .282095f;
+    basis[1] = .488603f * d.y;
+    basis[2] = .488603f * d.z;
+    basis[3] = .488603f * d.x;
+    basis[4] = 1.092548f * d.x * d.y;
+    basis[5] = 1.092548f * d.y * d.z;
+    basis[6] = .315392f * (3.f * d.z * d.z - 1.f);
+    basis[7] = 1.092548f * d.x * d.z;
+    basis[8] = .546274f * (d.x * d.x - d.y * d.y);
+}
+
+struct ProbeSH
+{
+    glm::vec3 coefficients[SH_COEFFICIENT_COUNT];
+};
+
+int main(int argc, char *argv[])
+{
+    // Parse arguments
+    const char *outputPath = NULL;
+    const char *albedoPath = NULL;
+    BakeSettings settings;
+    bool isValid = true;
+
+    // Numbers are parsed like the renderer's, a malformed or negative value falls through to the usage text
+    for (int i = 1; i < argc && isValid; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--objects" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.objectCount) == 1;
+        else if (arg == "--lights" && i + 1 < argc)
+        {
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.pointLightCount) == 1;
+            settings.pointLightCount = std::min(settings.pointLightCount, POINT_LIGHT_COUNT);
+        }
+        else if (arg == "--spacing" && i + 1 < argc)
+        {
+            isValid = std::sscanf(argv[++i], "%f", &settings.spacing) == 1 && std::isfinite(settings.spacing);
+            settings.spacing = std::max(settings.spacing, .1f);
+        }
+        else if (arg == "--samples" && i + 1 < argc)
+        {
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.sampleCount) == 1;
+            settings.sampleCount = std::max(settings.sampleCount, 1u);
+        }
+        else if (arg == "--bounces" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.bounceCount) == 1;
+        else if (arg == "--threads" && i + 1 < argc)
+            isValid = argv[++i][0] != '-' && std::sscanf(argv[i], "%u", &settings.threadCount) == 1;
+        else if (!outputPath)
+            outputPath = argv[i];
+        else if (!albedoPath)
+            albedoPath = argv[i];
+        else
+            isValid = false;
+    }
+    if (!isValid || !outputPath || !albedoPath || settings.objectCount == 0)
+    {
+        std::cout << "Usage: " << argv[0] << " <output> <albedo image> [--objects <count>] [--lights <0-" << POINT_LIGHT_COUNT << ">]\n"
+                  << "       [--spacing <units>] [--samples <per probe>] [--bounces <count>] [--threads <count>]\n"
+                  << "       --objects and --lights must match the renderer's, the albedo image tints bounce light" << std::endl;
+        return -1;
+    }
+
+    BakeScene scene;
+    if (!buildBakeScene(scene, settings.objectCount, settings.pointLightCount, albedoPath))
+        return -1;
+    ProbeGridLayout layout = probeGridLayout(settings.objectCount, settings.spacing);
+    size_t count = probeCount(layout);
+
+    // Project the light arriving from uniform directions onto the basis, probes are claimed one at a time
+    unsigned int threadCount = settings.threadCount ? settings.threadCount : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<ProbeSH> probes(count);
+    std::vector<unsigned char> isProbeValid(count, 0);
+    std::atomic<size_t> nextProbe(0);
+    auto startTime = std::chrono::steady_clock::now();
+    auto work = [&]() {
+        size_t index;
+        while ((index = nextProbe.fetch_add(1)) < count)
+        {
+            unsigned int x = static_cast<unsigned int>(index % layout.countX);
+            unsigned int y = static_cast<unsigned int>(index / layout.countX % layout.countY);
+            unsigned int z = static_cast<unsigned int>(index / (static_cast<size_t>(layout.countX) * layout.countY));
+            glm::vec3 position = probePosition(layout, x, y, z);
+            uint32_t random = seedRandom(index);
+            ProbeSH sh = {};
+            unsigned int backfaceCount = 0;
+            for (unsigned int sample = 0; sample < settings.sampleCount; sample++)
+            {
+                glm::vec3 direction = sampleSphere(random);
+                BVHHit hit;
+                if (scene.bvh.intersect(position, direction, std::numeric_limits<float>::max(), hit) &&
+                    glm::dot(scene.normals[hit.triangle], direction) > 0.f)
+                    backfaceCount++;
+
+                glm::vec3 radiance = incomingRadiance(scene, position, direction, settings.bounceCount, random);
+                float basis[SH_COEFFICIENT_COUNT];
+                shBasis(direction, basis);
+                for (unsigned int k = 0; k < SH_COEFFICIENT_COUNT; k++)
+                    sh.coefficients[k] += radiance * basis[k];
+            }
+            float weight = 4.f * 3.14159265f / settings.sampleCount;
+            for (unsigned int k = 0; k < SH_COEFFICIENT_COUNT; k++)
+                sh.coefficients[k] *= weight * SH_BAND_IRRADIANCE[SH_COEFFICIENT_BAND[k]];
+            probes[index] = sh;
+            isProbeValid[index] = backfaceCount <= INVALID_PROBE_BACKFACES * settings.sampleCount;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCount; i++)
+        threads.emplace_back(work);
+    for (std::thread &thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // Probes inside cubes only see black backfaces, grow the valid ones into them so surfaces never interpolate darkness
+    size_t invalidCount = std::count(isProbeValid.begin(), isProbeValid.end(), 0);
+    bool isGrowing = invalidCount < count;
+    while (isGrowing)
+    {
+        isGrowing = false;
+        std::vector<unsigned char> wasValid = isProbeValid;
+        for (size_t index = 0; index < count; index++)
+        {
+            if (wasValid[index])
+                continue;
+            int x = static_cast<int>(index % layout.countX);
+            int y = static_cast<int>(index / layout.countX % layout.countY);
+            int z = static_cast<int>(index / (static_cast<size_t>(layout.countX) * layout.countY));
+            ProbeSH sum = {};
+            unsigned int neighbourCount = 0;
+            for (int dz = -1; dz <= 1; dz++)
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        int nx = x + dx, ny = y + dy, nz = z + dz;
+                        if (nx < 0 || ny < 0 || nz < 0 || nx >= static_cast<int>(layout.countX) ||
+                            ny >= static_cast<int>(layout.countY) || nz >= static_cast<int>(layout.countZ))
+                            continue;
+                        size_t neighbour = (static_cast<size_t>(nz) * layout.countY + ny) * layout.countX + nx;
+                        if (!wasValid[neighbour])
+                            continue;
+                        for (unsigned int k = 0; k < SH_COEFFICIENT_COUNT; k++)
+                            sum.coefficients[k] += probes[neighbour].coefficients[k];
+                        neighbourCount++;
+                    }
+            if (neighbourCount == 0)
+                continue;
+            for (unsigned int k = 0; k < SH_COEFFICIENT_COUNT; k++)
+                probes[index].coefficients[k] = sum.coefficients[k] / static_cast<float>(neighbourCount);
+            isProbeValid[index] = 1;
+            isGrowing = true;
+        }
+    }
+
+    // Nine RGB coefficients fill seven RGBA texels, slot s of every probe goes to its own block of z slices
+    std::vector<uint16_t> halfTexels(count * LIGHT_PROBE_SLOTS * 4, glm::packHalf1x16(0.f));
+    for (size_t index = 0; index < count; index++)
+        for (unsigned int value = 0; value < SH_COEFFICIENT_COUNT * 3; value++)
+        {
+            size_t slot = value / 4;
+            halfTexels[(slot * count + index) * 4 + value % 4] = glm::packHalf1x16(probes[index].coefficients[value / 3][value % 3]);
+        }
+    if (!writeLightProbes(outputPath, layout, settings.objectCount, settings.pointLightCount, halfTexels))
+        return -1;
+    std::cout << "Baked " << count << " probes (" << layout.countX << "x" << layout.countY << "x" << layout.countZ << ", "
+              << layout.spacing << " apart, " << invalidCount << " inside cubes, " << settings.sampleCount << " samples, "
+              << settings.bounceCount << " bounces) on " << threadCount << " threads in " << seconds << " s -> " << outputPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Offline texture cooker: PNG/JPG in, block-compressed KTX2 with a precomputed mip chain out.
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+#include "ktx2.h"
+#include "texture.h"
+#include "block_compress.h"
+
+struct CookFormat
+{
+    const char *name;
+    unsigned int vkFormat;
+    unsigned int srgbVkFormat;    // 0 if the format has no sRGB variant
+    void (*encode)(const unsigned char *block, unsigned char *out);
+};
+
+const CookFormat COOK_FORMATS[] = {
+    { "bc1",  VK_FORMAT_BC1_RGB_UNORM_BLOCK,       VK_FORMAT_BC1_RGB_SRGB_BLOCK,       encodeBC1 },
+    { "bc3",  VK_FORMAT_BC3_UNORM_BLOCK,           VK_FORMAT_BC3_SRGB_BLOCK,           encodeBC3 },
+    { "bc4",  VK_FORMAT_BC4_UNORM_BLOCK,           0,                                  encodeBC4 },
+    { "bc5",  VK_FORMAT_BC5_UNORM_BLOCK,           0,                                  encodeBC5 },
+    { "bc7",  VK_FORMAT_BC7_UNORM_BLOCK,           VK_FORMAT_BC7_SRGB_BLOCK,           encodeBC7 },
+    { "etc2", VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,   VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,   encodeETC2 }
+};
+
+struct Image
+{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;    // RGBA8
+};
+
+// Colour channels are averaged in linear space when isColor is set
+Image downsample(const Image &source, bool isColor)
+{
+    Image level;
+    level.width = std::max(source.width / 2, 1);
+    level.height = std::max(source.height / 2, 1);
+    level.pixels = downsampleLevel(source.pixels.data(), source.width, source.height, 4, isColor);
+    return level;
+}
+
+// Encode every 4x4 block, edge texels are repeated into partial blocks
+std::vector<unsigned char> compressLevel(const Image &level, const CookFormat &format, unsigned int blockBytes)
+{
+    int blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+    std::vector<unsigned char> out(static_cast<size_t>(blocksX) * blocksY * blockBytes);
+    unsigned char block[64];
+    for (int by = 0; by < blocksY; by++)
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            for (int y = 0; y < 4; y++)
+                for (int x = 0; x < 4; x++)
+                {
+                    int sx = std::min(bx * 4 + x, level.width - 1), sy = std::min(by * 4 + y, level.height - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, &level.pixels[(static_cast<size_t>(sy) * level.width + sx) * 4], 4);
+                }
+            format.encode(block, &out[(static_cast<size_t>(by) * blocksX + bx) * blockBytes]);
+        }
+    return out;
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse arguments
+    const char *inputPath = NULL;
+    const char *outputPath = NULL;
+    const CookFormat *format = NULL;
+    bool isColor = false;
+    bool isSRGB = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            for (const CookFormat &candidate : COOK_FORMATS)
+                if (name == candidate.name)
+                    format = &candidate;
+        }
+        else if (arg == "--color")
+            isColor = true;
+        else if (arg == "--srgb")
+            isColor = isSRGB = true;
+        else if (!inputPath)
+            inputPath = argv[i];
+        else if (!outputPath)
+            outputPath = argv[i];
+        else
+        {
+            outputPath = NULL;
+            break;
+        }
+    }
+    if (!inputPath || !outputPath || !format)
+    {
+        std::cout << "Usage: " << argv[0] << " <input> <output.ktx2> --format bc1|bc3|bc4|bc5|bc7|etc2 [--color] [--srgb]\n"
+                  << "       --color  filter mips in linear space (sRGB-encoded colour data)\n"
+                  << "       --srgb   --color and store an sRGB format" << std::endl;
+        return -1;
+    }
+    if (isSRGB && !format->srgbVkFormat)
+    {
+        std::cout << "ERROR::TEXTURE_COOK::NO_SRGB_VARIANT: " << format->name << std::endl;
+        return -1;
+    }
+
+    Image image;
+    int components;
+    unsigned char *data = stbi_load(inputPath, &image.width, &image.height, &components, 4);
+    if (!data)
+    {
+        std::cout << "ERROR::TEXTURE_COOK::FAILED_TO_LOAD: " << inputPath << std::endl;
+        return -1;
+    }
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * 4);
+    stbi_image_free(data);
+
+    // Full chain down to 1x1
+    unsigned int vkFormat = isSRGB ? format->srgbVkFormat : format->vkFormat;
+    unsigned int blockBytes = ktx2BlockBytes(vkFormat);
+    std::vector<std::vector<unsigned char>> levels;
+    Image level = image;
+    while (true)
+    {
+        levels.push_back(compressLevel(level, *format, blockBytes));
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = downsample(level, isColor);
+    }
+
+    if (!writeKTX2(outputPath, vkFormat, image.width, image.height, levels))
+        return -1;
+    std::cout << "Cooked " << inputPath << " -> " << outputPath << " (" << format->name << (isSRGB ? " srgb" : "")
+              << ", " << levels.size() << " levels)" << std::endl;
+    return 0;
+}
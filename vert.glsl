@@ -3,10 +3,32 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
+#ifdef INSTANCED
+// Per-instance transform and material layer, replaces the model uniforms
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in mat3 instanceNormalModel;
+layout (location = 10) in float instanceMaterial;
+
+flat out float MaterialLayer;
+#else
 uniform mat4 model;
+uniform mat3 normalModel;
+#endif
+
+#ifdef BAKED_LIGHTING
+// Mesh lightmap UVs span one cube's block, the scale and offset place it in the atlas
+layout (location = 11) in vec2 aLightmapCoords;
+#ifdef INSTANCED
+layout (location = 12) in vec4 instanceLightmapScaleOffset;
+#else
+uniform vec4 lightmapScaleOffset;
+#endif
+
+out vec2 LightmapCoords;
+#endif
+
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat3 normalModel;
 
 out vec3 FragPos;
 out vec3 FragNorm;
@@ -14,8 +36,19 @@ out vec2 TextCoords;
 
 void main()
 {
+#ifdef INSTANCED
+    mat4 model = instanceModel;
+    mat3 normalModel = instanceNormalModel;
+    MaterialLayer = instanceMaterial;
+#endif
     gl_Position = projection * view * model * vec4(aPos, 1.0f);
     FragPos = vec3(model * vec4(aPos, 1.0));
     FragNorm = normalModel * aNormal;
     TextCoords = aTexCoords;
+#ifdef BAKED_LIGHTING
+#ifdef INSTANCED
+    vec4 lightmapScaleOffset = instanceLightmapScaleOffset;
+#endif
+    LightmapCoords = aLightmapCoords * lightmapScaleOffset.xy + lightmapScaleOffset.zw;
+#endif
 }
\ No newline at end of file